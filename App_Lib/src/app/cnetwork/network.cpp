@@ -28,7 +28,9 @@ namespace app::cnetwork {
 				if (createGame.game_rules().has_default_game_rules()) {
 					gameRoomConfig = game::DefaultGameRules::Config{};
 				} else if (createGame.game_rules().has_survival_game_rules()) {
-					gameRoomConfig = game::SurvivalGameRules::Config{};
+					gameRoomConfig = game::SurvivalGameRules::Config{
+						.seed = createGame.seed()
+					};
 				}
 			}
 			return gameRoomConfig;
@@ -509,6 +511,10 @@ namespace app::cnetwork {
 	}
 
 	void Network::handleCreateGame(const tp_s2c::CreateGame& createGame) {
+		if (createGame.width() <= 0 || createGame.width() > tetris::TetrisBoard::MaxColumns) {
+			spdlog::error("[Network] Invalid board width {} in CreateGame", createGame.width());
+			return;
+		}
 		connections_.clear();
 		players_.clear();
 		fillSlotsWithDevicesAndAis();
@@ -9,6 +9,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 #include <variant>
 
@@ -119,7 +121,18 @@ namespace app::game {
 
 	class SurvivalGameRules : public GameRules {
 	public:
-		struct Config {};
+		struct Config {
+			// Seed of the external rows, a seed from the operating system if empty.
+			std::optional<std::uint64_t> seed;
+		};
+
+		SurvivalGameRules()
+			: SurvivalGameRules{Config{}} {
+		}
+
+		explicit SurvivalGameRules(const Config& config)
+			: blockGenerator_{config.seed ? *config.seed : tetris::BlockGenerator::generateSeed()} {
+		}
 
 		void createGame(const std::vector<PlayerPtr>& players) override {
 			connections_.clear();
@@ -182,7 +195,7 @@ namespace app::game {
 
 		void addExternalRows(Player& player, int rows) {
 			for (int i = 0; i < rows; ++i) {
-				auto blockTypes = tetris::generateRow(player.getColumns(), 2);
+				auto blockTypes = tetris::generateRow(player.getColumns(), 2, blockGenerator_);
 				player.addExternalRows(blockTypes);
 			}
 		}
@@ -215,6 +228,7 @@ namespace app::game {
 			SurvivalPlayerData data;
 		};
 
+		tetris::BlockGenerator blockGenerator_;
 		std::vector<Info> players_;
 		mw::signals::ScopedConnections connections_;
 	};
@@ -200,7 +200,7 @@ namespace app::game {
 		clearedRows_ = clearedRows;
 	}
 
-	const std::vector<tetris::BlockType>& Player::getBoardVector() const {
+	std::vector<tetris::BlockType> Player::getBoardVector() const {
 		return tetrisBoard_.getBoardVector();
 	}
 
@@ -102,7 +102,7 @@ namespace app::game {
 
 		void setClearedRows(int clearedRows);
 
-		const std::vector<tetris::BlockType>& getBoardVector() const;
+		std::vector<tetris::BlockType> getBoardVector() const;
 
 	protected:
 		void handleBoardEvent(tetris::BoardEvent boardEvent, int value);
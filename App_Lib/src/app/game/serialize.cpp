@@ -142,6 +142,10 @@ namespace app::game {
 			}
 		}
 		if (cachedGame.has_player_board()) {
+			if (const int width = cachedGame.player_board().width(); width <= 0 || width > tetris::TetrisBoard::MaxColumns) {
+				spdlog::warn("[Serialize] Saved game has invalid board width {}", width);
+				return nullptr;
+			}
 			return createPlayer(devicePtr, cachedGame.player_board());
 		}
 		return nullptr;
@@ -19,7 +19,7 @@ namespace app {
 		}
 
 		std::unique_ptr<game::GameRules> createGameRulesInstance(const game::SurvivalGameRules::Config& config) {
-			return std::make_unique<game::SurvivalGameRules>();
+			return std::make_unique<game::SurvivalGameRules>(config);
 		}
 
 		std::unique_ptr<game::GameRules> createGameRules(const game::GameRulesConfig& gameRulesConfig) {
@@ -187,8 +187,8 @@ namespace app {
 		}
 	}
 
-	const char* TetrisController::getGameRoomId() const {
-		return network_->getGameRoomId().c_str();
+	std::string TetrisController::getGameRoomId() const {
+		return network_->getGameRoomId().toString();
 	}
 
 	bool TetrisController::isGameRoomSession() const {
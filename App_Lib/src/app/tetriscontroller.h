@@ -83,7 +83,7 @@ namespace app {
 
 		void updateGameRulesConfig(const game::GameRulesConfig& gameRulesConfig);
 
-		const char* getGameRoomId() const;
+		std::string getGameRoomId() const;
 
 		bool isGameRoomSession() const;
 
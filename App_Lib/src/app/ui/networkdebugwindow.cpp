@@ -61,7 +61,7 @@ namespace app::ui {
 		int id = 0;
 		for (auto& connectedClient : connectedClients_) {
 			ImGui::PushID(++id);
-			ImGui::Text("Connected: %s", connectedClient.clientId.c_str());
+			ImGui::Text("Connected: %s", connectedClient.clientId.toString().c_str());
 			ImGui::PopID();
 		}
 
@@ -100,8 +100,8 @@ namespace app::ui {
 						ImGui::Text("Remote Player");
 					}
 					ImGui::Text("Player name: %s", slot.name.c_str());
-					ImGui::Text("Client UUID: %s", slot.clientId.c_str());
-					ImGui::Text("Player UUID: %s", slot.playerId.c_str());
+					ImGui::Text("Client UUID: %s", slot.clientId.toString().c_str());
+					ImGui::Text("Player UUID: %s", slot.playerId.toString().c_str());
 					break;
 				case network::SlotType::Closed:
 					ImGui::Text("Closed Slot");
@@ -176,7 +176,7 @@ namespace app::ui::scene {
 				for (const auto& client : tetrisController_->getGameRoomClients()) {
 					ImGui::TableNextRow();
 					ImGui::TableNextColumn(); ImGui::TextWithBackgroundColor(client.connectionId, getColor(client.connectionId));
-					ImGui::TableNextColumn(); ImGui::Text("%s", client.clientId.c_str());
+					ImGui::TableNextColumn(); ImGui::Text("%s", client.clientId.toString().c_str());
 				}
 			});
 
@@ -76,13 +76,13 @@ namespace app::ui::scene {
 
 			for (const auto& gameRoom : gameRooms_) {
 				ImGui::TableNextRow();
-				ImGui::TableNextColumn(); ImGui::Text("%s", gameRoom.id.c_str());
+				ImGui::TableNextColumn(); ImGui::Text("%s", gameRoom.id.toString().c_str());
 				ImGui::TableNextColumn(); ImGui::Text("%s", gameRoom.name.c_str());
 				ImGui::TableNextColumn(); ImGui::Text("%i / %i", gameRoom.playerCount, gameRoom.maxPlayerCount);
 
 				ImGui::TableNextColumn();
 				if (ImGui::Button("Connect")) {
-					tetrisController_->joinGameRoom(gameRoom.id.c_str());
+					tetrisController_->joinGameRoom(gameRoom.id.toString());
 				}
 			}
 		});
@@ -67,14 +67,14 @@ namespace network {
 	TEST_F(GameRoomTest, receiveJoinGameRoom) {
 		// Given
 		auto joinGameRoom = wrapperFromClient.mutable_join_game_room();
-		fromCppToProto(GameRoomId{"game room id"}, *joinGameRoom->mutable_game_room_id());
+		fromCppToProto(GameRoomId{1}, *joinGameRoom->mutable_game_room_id());
 
 		// When
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 0"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{1}, wrapperFromClient);
 
 		// Then
 		ASSERT_EQ(gameRoom_->getConnectedClientIds().size(), 1);
-		ASSERT_EQ(gameRoom_->getConnectedClientIds()[0].clientId, ClientId{"client uuid 0"});
+		ASSERT_EQ(gameRoom_->getConnectedClientIds()[0].clientId, ClientId{1});
 	}
 
 	TEST_F(GameRoomTest, receiveGameRoomCreated) {
@@ -83,18 +83,18 @@ namespace network {
 		createGameRoom->set_name("name");
 
 		// When
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 0"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{1}, wrapperFromClient);
 
 		// Then
 		ASSERT_EQ(gameRoom_->getConnectedClientIds().size(), 1);
-		ASSERT_EQ(gameRoom_->getConnectedClientIds()[0].clientId, ClientId{"client uuid 0"});
+		ASSERT_EQ(gameRoom_->getConnectedClientIds()[0].clientId, ClientId{1});
 	}
 
 	TEST_F(GameRoomTest, receivePlayerSlot_thenSendGameLooby) {
 		// Given
 		auto createGameRoom = wrapperFromClient.mutable_create_game_room();
 		createGameRoom->set_name("name");
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 0"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{1}, wrapperFromClient);
 		wrapperFromClient.Clear();
 
 		auto mutablePlayerSlot = wrapperFromClient.mutable_player_slot();
@@ -111,18 +111,18 @@ namespace network {
 			}));
 
 		// When
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 0"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{1}, wrapperFromClient);
 
 		// Then
-		ASSERT_EQ(clientId, ClientId{"client uuid 0"});
+		ASSERT_EQ(clientId, ClientId{1});
 		const auto& playerSlot = wrapperToClient.game_looby();
 		
 		assertUniquePlayerIds(playerSlot, 2);
 		ASSERT_EQ(playerSlot.slots().size(), 4);
-		assertEqSlot(playerSlot, 0, tp_s2c::GameLooby_SlotType_REMOTE, "name 0", false, ClientId{"client uuid 0"});
-		assertEqSlot(playerSlot, 1, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{""});
-		assertEqSlot(playerSlot, 2, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{""});
-		assertEqSlot(playerSlot, 3, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{""});
+		assertEqSlot(playerSlot, 0, tp_s2c::GameLooby_SlotType_REMOTE, "name 0", false, ClientId{1});
+		assertEqSlot(playerSlot, 1, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{});
+		assertEqSlot(playerSlot, 2, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{});
+		assertEqSlot(playerSlot, 3, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{});
 	}
 
 	void addPlayerSlotFromClient(tp_c2s::PlayerSlot& playerSlot, const std::string& clientUuid, int index, const std::string& name, tp_c2s::PlayerSlot_SlotType slotType) {
@@ -133,7 +133,7 @@ namespace network {
 		// Given
 		auto createGameRoom = wrapperFromClient.mutable_create_game_room();
 		createGameRoom->set_name("name");
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 0"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{1}, wrapperFromClient);
 		wrapperFromClient.Clear();
 
 		tp_s2c::Wrapper wrapperToClient;
@@ -149,23 +149,23 @@ namespace network {
 		mutablePlayerSlot->set_index(0);
 		mutablePlayerSlot->set_name("name 0");
 		mutablePlayerSlot->set_slot_type(tp_c2s::PlayerSlot_SlotType_HUMAN);
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 0"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{1}, wrapperFromClient);
 
 		mutablePlayerSlot->set_index(1);
 		mutablePlayerSlot->set_name("name 1");
 		mutablePlayerSlot->set_slot_type(tp_c2s::PlayerSlot_SlotType_HUMAN);
-		gameRoom_->receiveMessage(mockServer_, ClientId{"client uuid 1"}, wrapperFromClient);
+		gameRoom_->receiveMessage(mockServer_, ClientId{2}, wrapperFromClient);
 
 		// Then
-		ASSERT_EQ(clientId, ClientId{"client uuid 0"});
+		ASSERT_EQ(clientId, ClientId{1});
 		const auto& playerSlot = wrapperToClient.game_looby();
 
 		assertUniquePlayerIds(playerSlot, 3);
 		ASSERT_EQ(playerSlot.slots().size(), 4);
-		assertEqSlot(playerSlot, 0, tp_s2c::GameLooby_SlotType_REMOTE, "name 0", false, ClientId{"client uuid 0"});
-		assertEqSlot(playerSlot, 1, tp_s2c::GameLooby_SlotType_REMOTE, "name 1", false, ClientId{"client uuid 1"});
-		assertEqSlot(playerSlot, 2, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{""});
-		assertEqSlot(playerSlot, 3, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{""});
+		assertEqSlot(playerSlot, 0, tp_s2c::GameLooby_SlotType_REMOTE, "name 0", false, ClientId{1});
+		assertEqSlot(playerSlot, 1, tp_s2c::GameLooby_SlotType_REMOTE, "name 1", false, ClientId{2});
+		assertEqSlot(playerSlot, 2, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{});
+		assertEqSlot(playerSlot, 3, tp_s2c::GameLooby_SlotType_OPEN_SLOT, "", false, ClientId{});
 	}
 
 	TEST_F(GameRoomTest, receiveRemoveClient_thenSendRemoveClient) {
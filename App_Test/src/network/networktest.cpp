@@ -141,18 +141,18 @@ namespace app::cnetwork {
 			}
 		});
 
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 
 		// When
 		EXPECT_FALSE(network_->isInsideRoom());
 		EXPECT_FALSE(createGameRoomEventCalled);
-		std::string expected = network_->getGameRoomId().c_str();
-		EXPECT_NE(network_->getGameRoomId(), network::GameRoomId{"server id"});
+		std::string expected = network_->getGameRoomId().toString();
+		EXPECT_NE(network_->getGameRoomId(), network::GameRoomId{1});
 		pollOne();
 
 		// Then.
-		std::string result = network_->getGameRoomId().c_str();
-		EXPECT_EQ(network_->getGameRoomId(), network::GameRoomId{"server id"});
+		std::string result = network_->getGameRoomId().toString();
+		EXPECT_EQ(network_->getGameRoomId(), network::GameRoomId{1});
 		EXPECT_TRUE(createGameRoomEventCalled);
 		EXPECT_TRUE(network_->isInsideRoom());
 	}
@@ -166,23 +166,23 @@ namespace app::cnetwork {
 			}
 		});
 
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 
 		// When
 		EXPECT_FALSE(joinGameRoomEventCalled);
 		EXPECT_FALSE(network_->isInsideRoom());
-		EXPECT_NE(network_->getGameRoomId(), network::GameRoomId{"server id"});
+		EXPECT_NE(network_->getGameRoomId(), network::GameRoomId{1});
 		pollOne();
 
 		// Then.
-		EXPECT_EQ(network_->getGameRoomId(), network::GameRoomId{"server id"});
+		EXPECT_EQ(network_->getGameRoomId(), network::GameRoomId{1});
 		EXPECT_TRUE(joinGameRoomEventCalled);
 		EXPECT_TRUE(network_->isInsideRoom());
 	}
 
 	TEST_F(NetworkTest, receiveGameLoobyContainingAllSlotTypes_thenEventsAreTriggered) {
 		// Given
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id 0"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 		pollOne();
 
 		std::vector<PlayerSlotEvent> actualPlayerSlotEvents;
@@ -193,12 +193,12 @@ namespace app::cnetwork {
 		});
 
 		auto gameLooby = wrapperFromServer.mutable_game_looby();
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 0"}, "name 0");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_CLOSED_SLOT, network::ClientId{""}, "");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 2"}, "name 2", false);
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{""}, "");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 4"}, "name 4", true);
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 0"}, "name 5", true);
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{1}, "name 0");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_CLOSED_SLOT, network::ClientId{}, "");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{3}, "name 2", false);
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{}, "");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{5}, "name 4", true);
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{1}, "name 5", true);
 
 		expectCallClientReceive(wrapperFromServer);
 
@@ -206,7 +206,7 @@ namespace app::cnetwork {
 		pollOne();
 
 		// Then.
-		EXPECT_EQ(network_->getGameRoomId(), network::GameRoomId{"server id"});
+		EXPECT_EQ(network_->getGameRoomId(), network::GameRoomId{1});
 		EXPECT_EQ(actualPlayerSlotEvents.size(), 6);
 		network::expectEqual(actualPlayerSlotEvents[0], 0, game::Human{
 			.name = "name 0"
@@ -228,7 +228,7 @@ namespace app::cnetwork {
 
 	TEST_F(NetworkTest, receiveGameLoobyAndSetSlot) {
 		// Given
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id 0"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 		pollOne();
 
 		wrapperFromServer.Clear();
@@ -259,11 +259,11 @@ namespace app::cnetwork {
 
 	TEST_F(NetworkTest, receiveGameLoobyAndSetSlotOutsideRange_thenIgnoreSlot) {
 		// Given
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id 0"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 		pollOne();
 
 		auto gameLooby = wrapperFromServer.mutable_game_looby();
-		network::addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{"client id 0"}, "name 0");
+		network::addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{1}, "name 0");
 
 		expectCallClientReceive(wrapperFromServer);
 		pollOne();
@@ -280,15 +280,15 @@ namespace app::cnetwork {
 
 	TEST_F(NetworkTest, receiveGameLoobyWithMultipleClientsAndSetSlot) {
 		// Given
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id 0"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 		pollOne();
 
 		wrapperFromServer.Clear();
 		auto gameLooby = wrapperFromServer.mutable_game_looby();
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 0"}, "name 0");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 1"}, "name 1");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{""}, "");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{""}, "");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{1}, "name 0");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{2}, "name 1");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{}, "");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_OPEN_SLOT, network::ClientId{}, "");
 
 		expectCallClientReceive(wrapperFromServer);
 		network::ProtobufMessage messageToServer;
@@ -318,7 +318,7 @@ namespace app::cnetwork {
 		player->set_current(tp::BlockType::J);
 		player->set_next(tp::BlockType::L);
 		player->set_points(2);
-		fromCppToProto(network::ClientId{"client id 0"}, *player->mutable_client_id());
+		fromCppToProto(network::ClientId{1}, *player->mutable_client_id());
 	}
 
 	// Assumes that the following events are received in order:
@@ -328,13 +328,13 @@ namespace app::cnetwork {
 	// TODO! Maybe CreateGame does not need to contain the same players as GameLooby??
 	TEST_F(NetworkTest, receiveCreateGame) {
 		// Given
-		mockReceiveGameRoomJoined(network::GameRoomId{"server id"}, network::ClientId{"client id 0"});
+		mockReceiveGameRoomJoined(network::GameRoomId{1}, network::ClientId{1});
 		pollOne();
 
 		wrapperFromServer.Clear();
 		auto gameLooby = wrapperFromServer.mutable_game_looby();
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 0"}, "name 0");
-		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{"client id 1"}, "name 1");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{1}, "name 0");
+		addPlayerSlot(*gameLooby, tp_s2c::GameLooby_SlotType_REMOTE, network::ClientId{2}, "name 1");
 		expectCallClientReceive(wrapperFromServer);
 		pollOne();
 
@@ -342,8 +342,8 @@ namespace app::cnetwork {
 		auto createGame = wrapperFromServer.mutable_create_game();
 		createGame->set_width(10);
 		createGame->set_height(20);
-		addCreateGamePlayer(*createGame, network::ClientId{"client id 0"}, "name 0", true);
-		addCreateGamePlayer(*createGame, network::ClientId{"client id 1"}, "name 1", true);
+		addCreateGamePlayer(*createGame, network::ClientId{1}, "name 0", true);
+		addCreateGamePlayer(*createGame, network::ClientId{2}, "name 1", true);
 		expectCallClientReceive(wrapperFromServer);
 		wrapperFromServer.Clear();
 
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <network/framereader.h>
 #include <network/protobufmessage.h>
 
 #include <protocol/shared.pb.h>
@@ -10,6 +11,8 @@
 #include <protocol/server_to_client.pb.h>
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 using namespace ::testing;
 
@@ -33,17 +36,17 @@ namespace network {
 	TEST_F(ProtobufMessageTest, createMessage) {
 		// Given
 		ProtobufMessage message;
-		EXPECT_EQ(message.getHeaderSize(), 2);
+		EXPECT_EQ(message.getHeaderSize(), 4);
 		EXPECT_EQ(message.getBodySize(), 0);
 		EXPECT_EQ(message.getSize(), 0);
 
 		// When
-		tp::GameRoomId expected;
-		expected.set_id("test");
+		tp_c2s::CreateGameRoom expected;
+		expected.set_name("test");
 		message.setBuffer(expected);
 
 		// Then
-		EXPECT_EQ(message.getHeaderSize(), 2);
+		EXPECT_EQ(message.getHeaderSize(), 4);
 		EXPECT_EQ(expected.ByteSizeLong(), message.getBodySize());
 		EXPECT_EQ(message.getSize(), message.getHeaderSize() + message.getBodySize());
 	}
@@ -51,18 +54,18 @@ namespace network {
 	TEST_F(ProtobufMessageTest, clearMessage) {
 		// Given
 		ProtobufMessage message;
-		tp::GameRoomId expected;
-		expected.set_id("test");
+		tp_c2s::CreateGameRoom expected;
+		expected.set_name("test");
 		message.setBuffer(expected);
 
 		// When
-		EXPECT_EQ(message.getHeaderSize(), 2);
+		EXPECT_EQ(message.getHeaderSize(), 4);
 		EXPECT_GT(message.getBodySize(), 0);
 		EXPECT_EQ(message.getSize(), message.getHeaderSize() + message.getBodySize());
 		message.clear();
 
 		// Then
-		EXPECT_EQ(message.getHeaderSize(), 2);
+		EXPECT_EQ(message.getHeaderSize(), 4);
 		EXPECT_EQ(message.getBodySize(), 0);
 		EXPECT_EQ(message.getSize(), 0);
 	}
@@ -70,24 +73,24 @@ namespace network {
 	TEST_F(ProtobufMessageTest, fromProtobufToMessageToProbuf) {
 		// Given
 		ProtobufMessage message;
-		tp::GameRoomId expected;
-		expected.set_id("test");
+		tp_c2s::CreateGameRoom expected;
+		expected.set_name("test");
 		message.setBuffer(expected);
 
 		// When
-		tp::GameRoomId result;
+		tp_c2s::CreateGameRoom result;
 		message.parseBodyInto(result);
 
 		// Then
-		auto text = expected.id();
-		EXPECT_EQ(expected.id(), std::string{"test"});
-		EXPECT_EQ(expected.id(), result.id());
+		auto text = expected.name();
+		EXPECT_EQ(expected.name(), std::string{"test"});
+		EXPECT_EQ(expected.name(), result.name());
 	}
 
 	TEST_F(ProtobufMessageTest, insertDataUsingMutableBuffer) {
 		// Given
-		tp::GameRoomId package;
-		package.set_id("test");
+		tp_c2s::CreateGameRoom package;
+		package.set_name("test");
 		ProtobufMessage message;
 		
 		// When
@@ -95,12 +98,74 @@ namespace network {
 		auto buffer = message.getMutableBodyBuffer();
 		package.SerializeToArray(buffer.data(), static_cast<int>(buffer.size()));
 
-		tp::GameRoomId result;
+		tp_c2s::CreateGameRoom result;
 		message.parseBodyInto(result);
 
 		// Then
-		EXPECT_EQ(package.id(), std::string{"test"});
-		EXPECT_EQ(package.id(), result.id());
+		EXPECT_EQ(package.name(), std::string{"test"});
+		EXPECT_EQ(package.name(), result.name());
+	}
+
+	TEST_F(ProtobufMessageTest, bodyLargerThan16Bits) {
+		// Given
+		tp_c2s::CreateGameRoom expected;
+		expected.set_name(std::string(70000, 'a'));
+		ProtobufMessage message;
+
+		// When
+		message.setBuffer(expected);
+
+		// Then
+		EXPECT_EQ(expected.ByteSizeLong(), message.getBodySize());
+		tp_c2s::CreateGameRoom result;
+		EXPECT_TRUE(message.parseBodyInto(result));
+		EXPECT_EQ(expected.name(), result.name());
+	}
+
+	TEST_F(ProtobufMessageTest, frameReaderSplitsCoalescedAndPartialFrames) {
+		// Given
+		std::vector<unsigned char> stream;
+		for (const char* id : {"first", "second", "third"}) {
+			tp_c2s::CreateGameRoom package;
+			package.set_name(id);
+			ProtobufMessage message;
+			message.setBuffer(package);
+			const auto buffer = message.getDataBuffer();
+			const auto data = static_cast<const unsigned char*>(buffer.data());
+			stream.insert(stream.end(), data, data + buffer.size());
+		}
+		FrameReader frameReader;
+		ProtobufMessage message;
+
+		// When, the first frame and a part of the second in one read.
+		const std::size_t firstRead = stream.size() / 2;
+		auto buffer = frameReader.prepare();
+		ASSERT_GE(buffer.size(), firstRead);
+		std::memcpy(buffer.data(), stream.data(), firstRead);
+		frameReader.commit(firstRead);
+
+		// Then
+		tp_c2s::CreateGameRoom result;
+		ASSERT_TRUE(frameReader.nextFrame(message));
+		EXPECT_TRUE(message.parseBodyInto(result));
+		EXPECT_EQ("first", result.name());
+		EXPECT_FALSE(frameReader.nextFrame(message));
+
+		// When, the rest.
+		buffer = frameReader.prepare();
+		ASSERT_GE(buffer.size(), stream.size() - firstRead);
+		std::memcpy(buffer.data(), stream.data() + firstRead, stream.size() - firstRead);
+		frameReader.commit(stream.size() - firstRead);
+
+		// Then
+		ASSERT_TRUE(frameReader.nextFrame(message));
+		EXPECT_TRUE(message.parseBodyInto(result));
+		EXPECT_EQ("second", result.name());
+		ASSERT_TRUE(frameReader.nextFrame(message));
+		EXPECT_TRUE(message.parseBodyInto(result));
+		EXPECT_EQ("third", result.name());
+		EXPECT_FALSE(frameReader.nextFrame(message));
+		EXPECT_EQ(0u, frameReader.getBufferedSize());
 	}
 
 }
@@ -26,6 +26,16 @@ namespace network {
 		/// @param message
 		virtual void send(ProtobufMessage&& message) = 0;
 
+		/// @brief Send a message shared with other clients, without serializing it again.
+		/// The default sends a copy.
+		/// @param message
+		virtual void send(SharedProtobufMessage message) {
+			ProtobufMessage copy;
+			acquire(copy);
+			copy = *message;
+			send(std::move(copy));
+		}
+
 		/// @brief Acquire a message from memory.
 		/// Used in order to avoid unnecessary memory allocations.
 		/// @param message
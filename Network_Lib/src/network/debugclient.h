@@ -29,6 +29,8 @@ namespace network {
 
 		asio::awaitable<ProtobufMessage> receive() override;
 
+		using Client::send;
+
 		void send(ProtobufMessage&& message) override;
 
 		void acquire(ProtobufMessage& message) override;
@@ -64,6 +66,8 @@ namespace network {
 
 		asio::awaitable<ProtobufMessage> receive() override;
 
+		using Client::send;
+
 		void send(ProtobufMessage&& message) override;
 
 		void acquire(ProtobufMessage& message) override;
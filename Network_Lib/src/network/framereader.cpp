@@ -0,0 +1,62 @@
+#include "framereader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace network {
+
+	asio::mutable_buffer FrameReader::prepare(std::size_t readSize) {
+		const std::size_t buffered = getBufferedSize();
+		if (buffered >= ProtobufMessage::HeaderSize) {
+			const std::size_t frameSize = ProtobufMessage::HeaderSize + ProtobufMessage::readBodySize(buffer_.data() + begin_);
+			if (frameSize > buffered) {
+				readSize = std::max(readSize, frameSize - buffered);
+			}
+		}
+
+		if (buffer_.size() - end_ < readSize) {
+			// Move the unread bytes to the front, before growing the buffer.
+			std::copy(buffer_.begin() + begin_, buffer_.begin() + end_, buffer_.begin());
+			begin_ = 0;
+			end_ = buffered;
+			if (buffer_.size() - end_ < readSize) {
+				buffer_.resize(end_ + readSize);
+			}
+		}
+		return asio::buffer(buffer_.data() + end_, buffer_.size() - end_);
+	}
+
+	void FrameReader::commit(std::size_t size) {
+		end_ += size;
+	}
+
+	bool FrameReader::nextFrame(ProtobufMessage& message) {
+		const std::size_t buffered = getBufferedSize();
+		if (buffered < ProtobufMessage::HeaderSize) {
+			return false;
+		}
+		const int bodySize = ProtobufMessage::readBodySize(buffer_.data() + begin_);
+		if (bodySize > ProtobufMessage::MaxBodySize) {
+			throw std::runtime_error{"Frame body size larger than " + std::to_string(ProtobufMessage::MaxBodySize) + " bytes"};
+		}
+		const std::size_t frameSize = ProtobufMessage::HeaderSize + bodySize;
+		if (buffered < frameSize) {
+			return false;
+		}
+
+		message.assignFrame({buffer_.data() + begin_, frameSize});
+		begin_ += frameSize;
+		if (begin_ == end_) {
+			begin_ = 0;
+			end_ = 0;
+		}
+		return true;
+	}
+
+	void FrameReader::clear() {
+		begin_ = 0;
+		end_ = 0;
+	}
+
+}
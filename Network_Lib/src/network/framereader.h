@@ -0,0 +1,47 @@
+#ifndef MWETRIS_NETWORK_FRAMEREADER_H
+#define MWETRIS_NETWORK_FRAMEREADER_H
+
+#include "protobufmessage.h"
+
+#include <asio/buffer.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace network {
+
+	/// @brief Receive buffer of one connection, split into the frames of ProtobufMessage.
+	/// 
+	/// Each read may hold many frames, or only a part of one, the bytes not yet part of
+	/// a whole frame are kept for the next read.
+	class FrameReader {
+	public:
+		static constexpr std::size_t DefaultReadSize = 8192;
+
+		/// @brief Buffer to read into, at least readSize bytes or the rest of the next frame.
+		/// Call commit() with the number of bytes read.
+		asio::mutable_buffer prepare(std::size_t readSize = DefaultReadSize);
+
+		void commit(std::size_t size);
+
+		/// @brief Copy the next whole frame into the message.
+		/// Throws std::runtime_error if the body size is larger than ProtobufMessage::MaxBodySize.
+		/// @return false if no whole frame is buffered.
+		bool nextFrame(ProtobufMessage& message);
+
+		/// @brief Remove all buffered bytes, e.g. when the connection is reconnected.
+		void clear();
+
+		std::size_t getBufferedSize() const noexcept {
+			return end_ - begin_;
+		}
+
+	private:
+		std::vector<unsigned char> buffer_;
+		std::size_t begin_ = 0;
+		std::size_t end_ = 0;
+	};
+
+}
+
+#endif
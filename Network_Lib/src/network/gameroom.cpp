@@ -4,8 +4,6 @@
 #include <protocol/server_to_client.pb.h>
 #include <protocol/client_to_server.pb.h>
 
-#include <tetris/helper.h>
-
 #include <spdlog/spdlog.h>
 
 namespace network {
@@ -78,9 +76,14 @@ namespace network {
 	}
 
 	GameRoom::GameRoom(const std::string& name, bool isPublic)
+		: GameRoom{name, isPublic, tetris::BlockGenerator::generateSeed()} {
+	}
+
+	GameRoom::GameRoom(const std::string& name, bool isPublic, std::uint64_t seed)
 		: name_{name}
 		, isPublic_{isPublic}
-		, connectionIds_{createIds(7)} {
+		, connectionIds_{createIds(7)}
+		, blockGenerator_{seed} {
 		
 		gameRoomId_ = GameRoomId::generateUniqueId();
 		playerSlots_.resize(4, Slot{.type = SlotType::Open});
@@ -92,12 +95,14 @@ namespace network {
 	GameRoom::~GameRoom() {}
 
 	void GameRoom::sendToAllClients(Server& server, const tp_s2c::Wrapper& message, const ClientId& exceptClientId) {
+		recipients_.clear();
 		for (const auto& [clientId, _] : connectedClients_) {
-			if (clientId == exceptClientId) {
-				continue;
+			if (clientId != exceptClientId) {
+				recipients_.push_back(clientId);
 			}
-			server.sendToClient(clientId, message);
 		}
+		// The message is serialized once for all clients.
+		server.sendToClients(recipients_, message);
 	}
 
 	const std::string& GameRoom::getName() const {
@@ -108,6 +113,10 @@ namespace network {
 		return isPublic_;
 	}
 
+	std::uint64_t GameRoom::getSeed() const {
+		return blockGenerator_.getSeed();
+	}
+
 	const GameRoomId& GameRoom::getGameRoomId() const {
 		return gameRoomId_;
 	}
@@ -161,8 +170,8 @@ namespace network {
 		// TODO!
 		wrapperToClient_.Clear();
 		auto gameRestart = wrapperToClient_.mutable_game_restart();
-		gameRestart->set_current(static_cast<tp::BlockType>(tetris::randomBlockType()));
-		gameRestart->set_next(static_cast<tp::BlockType>(tetris::randomBlockType()));
+		gameRestart->set_current(static_cast<tp::BlockType>(blockGenerator_.generateBlockType()));
+		gameRestart->set_next(static_cast<tp::BlockType>(blockGenerator_.generateBlockType()));
 		sendToAllClients(server, wrapperToClient_);
 	}
 
@@ -247,9 +256,10 @@ namespace network {
 		createGame->set_height(24);
 		gameRules_.CopyFrom(startGame.game_rules());
 		createGame->mutable_game_rules()->CopyFrom(gameRules_);
+		createGame->set_seed(blockGenerator_.generateChildSeed());
 
-		auto current = tetris::randomBlockType();
-		auto next = tetris::randomBlockType();
+		auto current = blockGenerator_.generateBlockType();
+		auto next = blockGenerator_.generateBlockType();
 
 		for (const auto& slot : playerSlots_) {
 			if (slot.type == SlotType::Remote) {
@@ -304,8 +314,8 @@ namespace network {
 	}
 
 	void GameRoom::handleRequestGameRestart(Server& server, const ClientId& clientId, const tp_c2s::RequestGameRestart& requestGameRestart) {
-		auto current = tetris::randomBlockType();
-		auto next = tetris::randomBlockType();
+		auto current = blockGenerator_.generateBlockType();
+		auto next = blockGenerator_.generateBlockType();
 		auto requestGameRestartToClient = wrapperToClient_.mutable_request_game_restart();
 		requestGameRestartToClient->set_current(static_cast<tp::BlockType>(current));
 		requestGameRestartToClient->set_next(static_cast<tp::BlockType>(next));
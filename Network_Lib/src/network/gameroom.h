@@ -7,6 +7,9 @@
 #include <protocol/server_to_client.pb.h>
 #include <protocol/client_to_server.pb.h>
 
+#include <tetris/blockgenerator.h>
+
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -19,14 +22,19 @@ namespace network {
 
 		GameRoom(const std::string& name, bool isPublic);
 
+		// The seed of the blocks sent to the clients, the same seed gives the same blocks.
+		GameRoom(const std::string& name, bool isPublic, std::uint64_t seed);
+
 		~GameRoom();
 
-		void sendToAllClients(Server& server, const tp_s2c::Wrapper& message, const ClientId& exceptClientId = ClientId{std::string{}});
+		void sendToAllClients(Server& server, const tp_s2c::Wrapper& message, const ClientId& exceptClientId = ClientId{});
 
 		const std::string& getName() const;
 
 		bool isPublic() const;
 
+		std::uint64_t getSeed() const;
+
 		const GameRoomId& getGameRoomId() const;
 
 		bool isFull() const;
@@ -86,6 +94,8 @@ namespace network {
 		tp_s2c::Wrapper wrapperToClient_;
 		tp::GameRules gameRules_;
 		std::list<int> connectionIds_;
+		tetris::BlockGenerator blockGenerator_;
+		std::vector<ClientId> recipients_;
 	};
 
 }
@@ -2,32 +2,50 @@
 
 #include <protocol/shared.pb.h>
 
+#include <charconv>
+#include <limits>
+#include <random>
+
 namespace network {
 
 	namespace {
 
-		constexpr std::string_view Characters = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
-
-		std::string generateUuid() {
-			static std::mt19937 generator{std::random_device{}()};
-			static std::uniform_int_distribution<> distribution{0, static_cast<int>(Characters.size() - 1)};
-
-			constexpr int UniqueIdSize = 16;
-			std::string unique(UniqueIdSize, 'X');
+		std::uint64_t generateId() {
+			static std::mt19937_64 generator{std::random_device{}()};
+			static std::uniform_int_distribution<std::uint64_t> distribution{1, std::numeric_limits<std::uint64_t>::max()};
+			return distribution(generator);
+		}
 
-			for (auto& key : unique) {
-				key = Characters[distribution(generator)];
+		std::string toHex(std::uint64_t id) {
+			if (id == 0) {
+				return {};
 			}
+			return fmt::format("{:016x}", id);
+		}
 
-			return unique;
+		std::uint64_t fromHex(std::string_view text) {
+			std::uint64_t id = 0;
+			auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), id, 16);
+			if (ec != std::errc{} || end != text.data() + text.size()) {
+				return 0;
+			}
+			return id;
 		}
 
 	}
 
-	// GameRoomId
+	// ClientId
 
 	ClientId ClientId::generateUniqueId() {
-		return ClientId{generateUuid()};
+		return ClientId{generateId()};
+	}
+
+	ClientId::ClientId(std::string_view text)
+		: id_{fromHex(text)} {
+	}
+
+	std::string ClientId::toString() const {
+		return toHex(id_);
 	}
 
 	ClientId::ClientId(const tp::ClientId& tpClientId)
@@ -57,7 +75,15 @@ namespace network {
 	// GameRoomId
 
 	GameRoomId GameRoomId::generateUniqueId() {
-		return GameRoomId{generateUuid()};
+		return GameRoomId{generateId()};
+	}
+
+	GameRoomId::GameRoomId(std::string_view text)
+		: id_{fromHex(text)} {
+	}
+
+	std::string GameRoomId::toString() const {
+		return toHex(id_);
 	}
 
 	GameRoomId::GameRoomId(const tp::GameRoomId& tpGameRoomId)
@@ -91,7 +117,15 @@ namespace network {
 	// PlayerId
 
 	PlayerId PlayerId::generateUniqueId() {
-		return PlayerId{generateUuid()};
+		return PlayerId{generateId()};
+	}
+
+	PlayerId::PlayerId(std::string_view text)
+		: id_{fromHex(text)} {
+	}
+
+	std::string PlayerId::toString() const {
+		return toHex(id_);
 	}
 
 	PlayerId::PlayerId(const tp::PlayerId& tpPlayerId)
@@ -3,8 +3,11 @@
 
 #include <fmt/core.h>
 #include <fmt/format.h>
-#include <string>
+
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <string_view>
 
 namespace tp {
 	
@@ -28,9 +31,12 @@ namespace network {
 
 		ClientId() = default;
 
-		explicit ClientId(const std::string& id)
+		explicit ClientId(std::uint64_t id)
 			: id_{id} {
 		}
+
+		// Parse the text from toString(), invalid text gives an empty id.
+		explicit ClientId(std::string_view text);
 	
 		// Implicit conversion from tp::ClientId to ClientId to simlify usage.
 		ClientId(const tp::ClientId& tpClientId);
@@ -44,7 +50,7 @@ namespace network {
 		}
 
 		explicit operator bool() const {
-			return !id_.empty();
+			return id_ != 0;
 		}
 
 		friend bool operator==(const tp::ClientId& lhs, const ClientId& rhs);
@@ -52,12 +58,12 @@ namespace network {
 		friend bool operator!=(const tp::ClientId& lhs, const ClientId& rhs);
 		friend bool operator!=(const ClientId& lhs, const tp::ClientId& rhs);
 
-		const char* c_str() const {
-			return id_.c_str();
-		}
+		// 16 hex digits, empty for an empty id.
+		std::string toString() const;
 
 	private:
-		std::string id_;
+		// Random and non zero, zero for an empty id.
+		std::uint64_t id_ = 0;
 	};
 
 	struct GameRoomClient {
@@ -77,10 +83,13 @@ namespace network {
 
 		GameRoomId() = default;
 
-		explicit GameRoomId(const std::string& id)
+		explicit GameRoomId(std::uint64_t id)
 			: id_{id} {
 		}
 
+		// Parse the text from toString(), invalid text gives an empty id.
+		explicit GameRoomId(std::string_view text);
+
 		// Implicit conversion from tp::GameRoomId to GameRoomId to simlify usage.
 		GameRoomId(const tp::GameRoomId& tpGameRoomId);
 		GameRoomId& operator=(const tp::GameRoomId& tpGameRoomId);
@@ -94,7 +103,7 @@ namespace network {
 		}
 
 		explicit operator bool() const {
-			return !id_.empty();
+			return id_ != 0;
 		}
 
 		friend bool operator==(const tp::GameRoomId& lhs, const GameRoomId& rhs);
@@ -102,16 +111,15 @@ namespace network {
 		friend bool operator!=(const tp::GameRoomId& lhs, const GameRoomId& rhs);
 		friend bool operator!=(const GameRoomId& lhs, const tp::GameRoomId& rhs);
 
-		const char* c_str() const {
-			return id_.c_str();
-		}
+		// 16 hex digits, empty for an empty id.
+		std::string toString() const;
 
 		bool isEmpty() const {
-			return id_.empty();
+			return id_ == 0;
 		}
 
 	private:
-		std::string id_;
+		std::uint64_t id_ = 0;
 	};
 
 	class PlayerId {
@@ -126,8 +134,12 @@ namespace network {
 
 		PlayerId() = default;
 
-		explicit PlayerId(const std::string& id)
-			: id_{id} {}
+		explicit PlayerId(std::uint64_t id)
+			: id_{id} {
+		}
+
+		// Parse the text from toString(), invalid text gives an empty id.
+		explicit PlayerId(std::string_view text);
 
 		// Implicit conversion from tp::PlayerId to PlayerId to simlify usage.
 		PlayerId(const tp::PlayerId& tpPlayerId);
@@ -142,7 +154,7 @@ namespace network {
 		}
 
 		explicit operator bool() const {
-			return !id_.empty();
+			return id_ != 0;
 		}
 
 		friend bool operator==(const tp::PlayerId& lhs, const PlayerId& rhs);
@@ -150,12 +162,11 @@ namespace network {
 		friend bool operator!=(const tp::PlayerId& lhs, const PlayerId& rhs);
 		friend bool operator!=(const PlayerId& lhs, const tp::PlayerId& rhs);
 
-		const char* c_str() const {
-			return id_.c_str();
-		}
+		// 16 hex digits, empty for an empty id.
+		std::string toString() const;
 
 	private:
-		std::string id_;
+		std::uint64_t id_ = 0;
 	};
 
 }
@@ -164,7 +175,7 @@ namespace network {
 
 template <> struct fmt::formatter<network::ClientId> : fmt::formatter<std::string_view> {
 	auto format(const network::ClientId& clientId, fmt::format_context& ctx) const {
-		return formatter<string_view>::format(clientId.id_, ctx);
+		return formatter<string_view>::format(clientId.toString(), ctx);
 	}
 };
 
@@ -177,7 +188,7 @@ template <> struct fmt::formatter<tp::ClientId> : fmt::formatter<network::Client
 template <>
 struct std::hash<network::ClientId> {
 	inline size_t operator()(const network::ClientId& clientId) const {
-		return std::hash<std::string_view>{}(clientId.id_);
+		return std::hash<std::uint64_t>{}(clientId.id_);
 	}
 };
 
@@ -191,7 +202,7 @@ template<> struct std::less<network::ClientId> {
 
 template <> struct fmt::formatter<network::GameRoomId> : fmt::formatter<std::string_view> {
 	auto format(const network::GameRoomId& clientId, fmt::format_context& ctx) const {
-		return formatter<string_view>::format(clientId.id_, ctx);
+		return formatter<string_view>::format(clientId.toString(), ctx);
 	}
 };
 
@@ -204,7 +215,7 @@ template <> struct fmt::formatter<tp::GameRoomId> : fmt::formatter<network::Game
 template <>
 struct std::hash<network::GameRoomId> {
 	inline size_t operator()(const network::GameRoomId& clientId) const {
-		return std::hash<std::string_view>{}(clientId.id_);
+		return std::hash<std::uint64_t>{}(clientId.id_);
 	}
 };
 
@@ -218,7 +229,7 @@ template<> struct std::less<network::GameRoomId> {
 
 template <> struct fmt::formatter<network::PlayerId> : fmt::formatter<std::string_view> {
 	auto format(const network::PlayerId& clientId, fmt::format_context& ctx) const {
-		return formatter<string_view>::format(clientId.id_, ctx);
+		return formatter<string_view>::format(clientId.toString(), ctx);
 	}
 };
 
@@ -231,7 +242,7 @@ template <> struct fmt::formatter<tp::PlayerId> : fmt::formatter<network::Player
 template <>
 struct std::hash<network::PlayerId> {
 	inline size_t operator()(const network::PlayerId& clientId) const {
-		return std::hash<std::string_view>{}(clientId.id_);
+		return std::hash<std::uint64_t>{}(clientId.id_);
 	}
 };
 
@@ -1,5 +1,9 @@
 #include "protobufmessage.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
 namespace network {
 
 	ProtobufMessage::ProtobufMessage() {
@@ -24,14 +28,6 @@ namespace network {
 		defineBodySize();
 	}
 
-	void ProtobufMessage::reserveHeaderSize() {
-		buffer_.resize(getHeaderSize());
-	}
-
-	void ProtobufMessage::reserveBodySize() {
-		buffer_.resize(getHeaderSize() + getBodySize());
-	}
-
 	void ProtobufMessage::reserveBodySize(int size) {
 		buffer_.resize(getHeaderSize() + size);
 		defineBodySize();
@@ -41,14 +37,28 @@ namespace network {
 		if (buffer_.empty()) {
 			return 0;
 		}
-		return 255 * buffer_[0] + buffer_[1];
+		return readBodySize(buffer_.data());
+	}
+
+	void ProtobufMessage::assignFrame(std::span<const unsigned char> frame) {
+		assert(frame.size() >= HeaderSize && static_cast<std::size_t>(readBodySize(frame.data())) + HeaderSize == frame.size());
+		buffer_.assign(frame.begin(), frame.end());
+	}
+
+	int ProtobufMessage::readBodySize(const unsigned char* header) noexcept {
+		const auto bodySize = (std::uint32_t{header[0]} << 24) | (std::uint32_t{header[1]} << 16)
+			| (std::uint32_t{header[2]} << 8) | std::uint32_t{header[3]};
+		// Larger than any valid frame, without overflowing the int.
+		return static_cast<int>(std::min<std::uint32_t>(bodySize, MaxBodySize + 1u));
 	}
 
 	void ProtobufMessage::defineBodySize() {
 		auto bodySize = buffer_.size() - getHeaderSize(); // Buffer size is at least header size.
-		assert(bodySize < 65536);
-		buffer_[0] = ((bodySize >> 8) & 0xFF);
-		buffer_[1] = (bodySize & 0xFF);
+		assert(bodySize <= MaxBodySize);
+		buffer_[0] = (bodySize >> 24) & 0xFF;
+		buffer_[1] = (bodySize >> 16) & 0xFF;
+		buffer_[2] = (bodySize >> 8) & 0xFF;
+		buffer_[3] = bodySize & 0xFF;
 	}
 
 }
@@ -5,6 +5,9 @@
 #include <asio/buffer.hpp>
 
 #include <concepts>
+#include <cstddef>
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace network {
@@ -12,8 +15,14 @@ namespace network {
 	template <typename Message>
 	concept MessageLite = std::derived_from<Message, google::protobuf::MessageLite>;
 
+	// A protobuf message in a frame, a 4 byte big endian body size followed by the body.
 	class ProtobufMessage {
 	public:
+		static constexpr int HeaderSize = 4;
+
+		// Larger frames are not read, i.e. a corrupt stream is not mistaken for a huge message.
+		static constexpr int MaxBodySize = 16 * 1024 * 1024;
+
 		ProtobufMessage();
 
 		explicit ProtobufMessage(int size);
@@ -27,18 +36,23 @@ namespace network {
 		}
 
 		constexpr int getHeaderSize() const noexcept {
-			return 2;
+			return HeaderSize;
 		}
-		
-		void reserveHeaderSize();
-
-		void reserveBodySize();
 
-		// At most 65535 bytes (2^16 - 1)
+		// At most MaxBodySize bytes.
 		void reserveBodySize(int size);
 
 		int getBodySize() const;
 
+		/// @brief Copy a whole frame, header and body, into the message. The memory already
+		/// allocated by the message is reused.
+		/// @param frame of HeaderSize plus the body size in the header bytes.
+		void assignFrame(std::span<const unsigned char> frame);
+
+		/// @brief Decode the body size in the header.
+		/// @param header at least HeaderSize bytes.
+		static int readBodySize(const unsigned char* header) noexcept;
+
 		asio::const_buffer getDataBuffer() const {
 			return asio::buffer(buffer_);
 		}
@@ -73,6 +87,9 @@ namespace network {
 		std::vector<unsigned char> buffer_;
 	};
 
+	// A message serialized once and sent to many clients, must not change while shared.
+	using SharedProtobufMessage = std::shared_ptr<const ProtobufMessage>;
+
 }
 
 #endif
@@ -5,6 +5,8 @@
 
 #include <google/protobuf/message_lite.h>
 
+#include <span>
+
 namespace network {
 
 	struct ConnectedClient {
@@ -31,6 +33,13 @@ namespace network {
 		
 		virtual void sendToClient(const ClientId& clientId, const google::protobuf::MessageLite& message) = 0;
 
+		/// @brief Send the same message to all clients. The default sends to one client at a time.
+		virtual void sendToClients(std::span<const ClientId> clientIds, const google::protobuf::MessageLite& message) {
+			for (const auto& clientId : clientIds) {
+				sendToClient(clientId, message);
+			}
+		}
+
 		virtual void triggerConnectedClientEvent(const ConnectedClient& connectedClient) = 0;
 
 		virtual void triggerPlayerSlotEvent(const std::vector<Slot>& slots) = 0;
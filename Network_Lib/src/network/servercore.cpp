@@ -56,7 +56,7 @@ namespace network {
 		}
 
 		if (auto it = roomIdByClientId_.find(fromRemote.clientId); it != roomIdByClientId_.end()) {
-			auto& gameRoom = gameRoomById_.at(roomIdByClientId_.at(fromRemote.clientId));
+			auto& gameRoom = gameRoomById_.at(it->second);
 			gameRoom.receiveMessage(*this, fromRemote.clientId, wrapper);
 		}
 	}
@@ -165,10 +165,25 @@ namespace network {
 	}
 
 	void ServerCore::sendToClient(const ClientId& clientId, const google::protobuf::MessageLite& message) {
-		for (const auto& [_, remote] : remoteByClientId_) {
-			if (remote.clientId == clientId) {
-				sendToClient(*remote.client, message);
-				break;
+		if (auto it = remoteByClientId_.find(clientId); it != remoteByClientId_.end()) {
+			sendToClient(*it->second.client, message);
+		}
+	}
+
+	void ServerCore::sendToClients(std::span<const ClientId> clientIds, const google::protobuf::MessageLite& message) {
+		if (clientIds.size() == 1) {
+			sendToClient(clientIds.front(), message);
+			return;
+		}
+		SharedProtobufMessage sharedMessage;
+		for (const auto& clientId : clientIds) {
+			if (auto it = remoteByClientId_.find(clientId); it != remoteByClientId_.end()) {
+				if (!sharedMessage) {
+					auto protobufMessage = std::make_shared<ProtobufMessage>();
+					protobufMessage->setBuffer(message);
+					sharedMessage = std::move(protobufMessage);
+				}
+				it->second.client->send(sharedMessage);
 			}
 		}
 	}
@@ -196,8 +211,14 @@ namespace network {
 	}
 
 	void ServerCore::sendToClients(const google::protobuf::MessageLite& wrapper) {
+		if (remoteByClientId_.empty()) {
+			return;
+		}
+		auto message = std::make_shared<ProtobufMessage>();
+		message->setBuffer(wrapper);
+		const SharedProtobufMessage sharedMessage = std::move(message);
 		for (const auto& [_, remote] : remoteByClientId_) {
-			sendToClient(*remote.client, wrapper);
+			remote.client->send(sharedMessage);
 		}
 	}
 
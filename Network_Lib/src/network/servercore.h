@@ -15,6 +15,7 @@
 #include <mw/signal.h>
 
 #include <optional>
+#include <unordered_map>
 
 namespace network {
 
@@ -83,6 +84,8 @@ namespace network {
 
 		void sendToClient(const ClientId& clientId, const google::protobuf::MessageLite& message) override;
 
+		void sendToClients(std::span<const ClientId> clientIds, const google::protobuf::MessageLite& message) override;
+
 		void triggerConnectedClientEvent(const ConnectedClient& connectedClient) override;
 
 		void triggerPlayerSlotEvent(const std::vector<Slot>& slots) override;
@@ -98,9 +101,10 @@ namespace network {
 		OptionalRef<GameRoom> findGameRoom(const ClientId& clientId);
 
 		asio::io_context& ioContext_;
-		std::map<ClientId, GameRoomId> roomIdByClientId_;
-		std::map<GameRoomId, GameRoom> gameRoomById_;
-		std::map<ClientId, Remote> remoteByClientId_;
+		// Looked up for each received and routed message, hashed to not depend on the number of clients.
+		std::unordered_map<ClientId, GameRoomId> roomIdByClientId_;
+		std::unordered_map<GameRoomId, GameRoom> gameRoomById_;
+		std::unordered_map<ClientId, Remote> remoteByClientId_;
 
 		tp_c2s::Wrapper wrapperFromClient_;
 		tp_s2c::Wrapper wrapperToClient_;
@@ -1,6 +1,7 @@
 #include "tcpclient.h"
 #include "protobufmessagequeue.h"
 
+#include <algorithm>
 #include <queue>
 #include <spdlog/spdlog.h>
 
@@ -8,6 +9,18 @@ using namespace std::chrono_literals;
 
 namespace network {
 
+	namespace {
+
+		template <typename OutgoingMessage>
+		const ProtobufMessage& getMessage(const OutgoingMessage& message) {
+			if (auto sharedMessage = std::get_if<SharedProtobufMessage>(&message)) {
+				return **sharedMessage;
+			}
+			return std::get<ProtobufMessage>(message);
+		}
+
+	}
+
 	std::shared_ptr<TcpClient> TcpClient::connectToServer(asio::io_context& ioContext, const std::string& ip, int port) {
 		auto client = std::shared_ptr<TcpClient>{new TcpClient{ioContext, ip, port}};
 
@@ -26,6 +39,9 @@ namespace network {
 		} catch (const asio::system_error& e) {
 			spdlog::error("[TcpClient] {} Stop Exception: {}", name_, e.what());
 		}
+		// The write in progress, if any, completes with an error and releases its messages.
+		releaseQueuedMessages();
+		++connection_;
 		isStopped_ = true;
 		connected_ = false;
 	}
@@ -53,6 +69,7 @@ namespace network {
 
 	asio::awaitable<void> TcpClient::connect() {
 		socket_ = asio::ip::tcp::socket{ioContext_};
+		frameReader_.clear();
 		isStopped_ = false;
 		connected_ = false;
 
@@ -134,18 +151,16 @@ namespace network {
 		queue_.acquire(protobufMessage);
 
 		try {
-			// Read header.
-			protobufMessage.reserveHeaderSize();
-			std::size_t size = co_await socket_.async_read_some(protobufMessage.getMutableDataBuffer(), asio::use_awaitable);
-
-			// Read body.
-			protobufMessage.reserveBodySize();
-			size = co_await socket_.async_read_some(protobufMessage.getMutableBodyBuffer(), asio::use_awaitable);
+			// One read may hold many frames, or only a part of one.
+			while (!frameReader_.nextFrame(protobufMessage)) {
+				const std::size_t size = co_await socket_.async_read_some(frameReader_.prepare(), asio::use_awaitable);
+				frameReader_.commit(size);
+			}
 		} catch (const std::exception& e) {
 			spdlog::error("[TcpClient] {} async_read Exception: {}", name_, e.what());
 			
 			stop();
-			throw e;
+			throw;
 		}
 
 		co_return protobufMessage;
@@ -165,20 +180,77 @@ namespace network {
 	}
 
 	void TcpClient::send(ProtobufMessage&& message) {
-		const auto buffer = message.getDataBuffer();
-		
-		asio::async_write(socket_, buffer, asio::transfer_exactly(buffer.size()),
-			// message is saved in pb so buffer is not destroyed.
-			[client = shared_from_this(), pb = std::move(message)](std::error_code ec, std::size_t length) mutable {
-
-			if (ec) {
-				spdlog::warn("[TcpClient] {} async_write Error code: {}, length: {}", client->name_, ec.message(), length);
-			}
-			
-			client->release(std::move(pb));
+		enqueue(std::move(message));
+	}
+
+	void TcpClient::send(SharedProtobufMessage message) {
+		enqueue(std::move(message));
+	}
+
+	void TcpClient::enqueue(OutgoingMessage&& message) {
+		queuedBytes_ += getMessage(message).getSize();
+		sendQueue_.push_back(std::move(message));
+		if (queuedBytes_ > MaxQueuedBytes) {
+			spdlog::error("[TcpClient] {} More than {} bytes queued to be sent, stop", name_, MaxQueuedBytes);
+			stop();
+			return;
+		}
+		flush();
+	}
+
+	void TcpClient::flush() {
+		if (writing_ || sendQueue_.empty()) {
+			return;
+		}
+		writing_ = true;
+
+		// The messages sent while the last write was in progress are sent together.
+		const auto messages = std::min(sendQueue_.size(), MaxMessagesPerWrite);
+		for (std::size_t i = 0; i < messages; ++i) {
+			writingMessages_.push_back(std::move(sendQueue_.front()));
+			sendQueue_.pop_front();
+			writeBuffers_.push_back(getMessage(writingMessages_.back()).getDataBuffer());
+		}
+
+		// The buffers point into writingMessages_, unchanged until the write is done.
+		asio::async_write(socket_, writeBuffers_, [client = shared_from_this(), connection = connection_](std::error_code ec, std::size_t length) {
+			client->handleWritten(ec, length, connection);
 		});
 	}
 
+	void TcpClient::handleWritten(std::error_code ec, std::size_t length, std::uint64_t connection) {
+		for (auto& message : writingMessages_) {
+			releaseMessage(std::move(message));
+		}
+		writingMessages_.clear();
+		writeBuffers_.clear();
+		writing_ = false;
+
+		if (ec && connection == connection_) {
+			spdlog::warn("[TcpClient] {} async_write Error code: {}, length: {}", name_, ec.message(), length);
+			// The connection is broken, the rest would fail too.
+			releaseQueuedMessages();
+			return;
+		}
+		// After a stop the queued messages were sent for the new connection.
+		flush();
+	}
+
+	void TcpClient::releaseMessage(OutgoingMessage&& message) {
+		queuedBytes_ -= getMessage(message).getSize();
+		// A shared message is freed by the last client.
+		if (auto protobufMessage = std::get_if<ProtobufMessage>(&message)) {
+			release(std::move(*protobufMessage));
+		}
+	}
+
+	void TcpClient::releaseQueuedMessages() {
+		for (auto& message : sendQueue_) {
+			releaseMessage(std::move(message));
+		}
+		sendQueue_.clear();
+	}
+
 	void TcpClient::acquire(ProtobufMessage& message) {
 		queue_.acquire(message);
 	}
@@ -3,19 +3,31 @@
 
 #include "client.h"
 #include "asio.h"
+#include "framereader.h"
 #include "protobufmessage.h"
 #include "protobufmessagequeue.h"
 
 #include <mw/signal.h>
 
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <queue>
+#include <variant>
+#include <vector>
 
 namespace network {
 
 	class TcpClient : public Client, public std::enable_shared_from_this<TcpClient> {
 	public:
+		/// @brief Most bytes queued to be sent, before the connection is stopped. I.e. a
+		/// receiver that can't keep up is disconnected instead of using all memory.
+		static constexpr std::size_t MaxQueuedBytes = 4 * 1024 * 1024;
+
+		/// @brief Most messages sent in one gather write.
+		static constexpr std::size_t MaxMessagesPerWrite = 64;
+
 		/// @brief Connect to server.
 		/// @param ioContext to use for asynchronous operations.
 		static std::shared_ptr<TcpClient> connectToServer(asio::io_context& ioContext, const std::string& ip, int port);
@@ -31,6 +43,9 @@ namespace network {
 
 		void send(ProtobufMessage&& message) override;
 
+		/// @brief Queue the shared message, the buffer is written without a copy.
+		void send(SharedProtobufMessage message) override;
+
 		void acquire(ProtobufMessage& message) override;
 
 		void release(ProtobufMessage&& message) override;
@@ -47,6 +62,9 @@ namespace network {
 		void reconnect() override;
 
 	private:
+		// A message owned by this client, or shared with other clients.
+		using OutgoingMessage = std::variant<ProtobufMessage, SharedProtobufMessage>;
+
 		asio::ip::tcp::endpoint getEndpoint() const;
 
 		asio::awaitable<void> connect();
@@ -61,6 +79,19 @@ namespace network {
 
 		asio::awaitable<void> waitForConnection();
 
+		void enqueue(OutgoingMessage&& message);
+
+		/// @brief Write the queued messages in one gather write, unless a write is in progress.
+		void flush();
+
+		/// @brief Release the written messages. A write error on the current connection releases the
+		/// queued messages too, an error from a stopped connection keeps them for the next one.
+		void handleWritten(std::error_code ec, std::size_t length, std::uint64_t connection);
+
+		void releaseMessage(OutgoingMessage&& message);
+
+		void releaseQueuedMessages();
+
 		/// @brief Keeps this tcp client alive until the async operation is done.
 		/// @param client to act on
 		/// @return coroutine handle.
@@ -70,6 +101,16 @@ namespace network {
 		asio::ip::tcp::endpoint endpoint_;
 		asio::high_resolution_timer tryToConnectTimer_, waitingToConnect_;
 		asio::ip::tcp::socket socket_;
+		FrameReader frameReader_;
+		// Messages to send, waiting for the write in progress.
+		std::deque<OutgoingMessage> sendQueue_;
+		// The messages and buffers of the write in progress.
+		std::vector<OutgoingMessage> writingMessages_;
+		std::vector<asio::const_buffer> writeBuffers_;
+		std::size_t queuedBytes_ = 0;
+		bool writing_ = false;
+		// Incremented when stopped, i.e. identifies the connection a write was started on.
+		std::uint64_t connection_ = 0;
 		ProtobufMessageQueue queue_;
 		std::string name_;
 		bool isStopped_ = true;
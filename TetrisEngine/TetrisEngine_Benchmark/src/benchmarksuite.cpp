@@ -0,0 +1,217 @@
+#include <benchmark/benchmark.h>
+
+#include <tetris/ai.h>
+#include <tetris/blockgenerator.h>
+#include <tetris/helper.h>
+#include <tetris/tetrisboard.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+// Benchmarks of the ai search, the board moves, line clears and whole games, for several board
+// sizes. Write the results as json, for regression tracking, with:
+//   TetrisEngine_Benchmark --benchmark_out=result.json --benchmark_out_format=json
+// or build the target TetrisEngine_Benchmark_Json.
+
+using namespace tetris;
+
+namespace {
+
+	constexpr std::array<std::array<int, 2>, 3> BoardSizes{{{10, 24}, {16, 32}, {32, 48}}};
+	constexpr std::array<int, 4> FillPercentages{0, 25, 50, 75};
+	constexpr int CorpusSize = 32;
+	constexpr int MaxGameTurns = 500;
+	constexpr std::uint64_t Seed = 1;
+
+	// Boards with the lowest rows filled with random squares and one to three holes in each row.
+	std::vector<TetrisBoard> createBoardCorpus(int columns, int rows, int fillPercentage) {
+		BlockGenerator blockGenerator{Seed};
+		const int filledRows = rows * fillPercentage / 100;
+
+		std::vector<TetrisBoard> boards;
+		for (int i = 0; i < CorpusSize; ++i) {
+			TetrisBoard board{columns, rows, blockGenerator.generateBlockType(), blockGenerator.generateBlockType()};
+			std::vector<BlockType> externalRows;
+			for (int row = 0; row < filledRows; ++row) {
+				const auto squares = generateRow(columns, blockGenerator.generateInt(1, 3), blockGenerator);
+				externalRows.insert(externalRows.end(), squares.begin(), squares.end());
+			}
+			board.addExternalRows(externalRows);
+			boards.push_back(board);
+		}
+		return boards;
+	}
+
+	// Board with a vertical I block at ground in the leftmost column, clearing the lowest rows.
+	// All rows are empty in the leftmost column, the rows to be cleared are otherwise filled and
+	// the rows up to half the board have one more hole.
+	TetrisBoard createClearRowsBoard(int columns, int rows, int clearedRows) {
+		BlockGenerator blockGenerator{Seed};
+		std::vector<BlockType> squares;
+		for (int row = 0; row < rows / 2; ++row) {
+			auto squaresInRow = generateRow(columns, 0, blockGenerator);
+			squaresInRow[0] = BlockType::Empty;
+			if (row >= clearedRows) {
+				squaresInRow[blockGenerator.generateInt(1, columns - 1)] = BlockType::Empty;
+			}
+			squares.insert(squares.end(), squaresInRow.begin(), squaresInRow.end());
+		}
+
+		Block block{BlockType::I, columns / 2 - 1, rows - 4};
+		auto isVertical = [&]() {
+			const int column = (*block.begin()).column;
+			return std::all_of(block.begin(), block.end(), [&](const Square& square) { return square.column == column; });
+		};
+		while (!isVertical()) {
+			block.rotateLeft();
+		}
+		while ((*block.begin()).column > 0) {
+			block.moveLeft();
+		}
+		const TetrisBoard board{squares, columns, rows, block, BlockType::O};
+		return TetrisBoard{squares, columns, rows, board.getBlockDown(block), BlockType::O};
+	}
+
+	void applyAiArguments(benchmark::internal::Benchmark* benchmark) {
+		benchmark->ArgNames({"width", "height", "depth", "fill"});
+		for (const auto& [columns, rows] : BoardSizes) {
+			for (int depth : {0, 1, 2}) {
+				for (int fillPercentage : FillPercentages) {
+					benchmark->Args({columns, rows, depth, fillPercentage});
+				}
+			}
+		}
+	}
+
+	void applyBoardSizeArguments(benchmark::internal::Benchmark* benchmark) {
+		benchmark->ArgNames({"width", "height"});
+		for (const auto& [columns, rows] : BoardSizes) {
+			benchmark->Args({columns, rows});
+		}
+	}
+
+	void applyMoveArguments(benchmark::internal::Benchmark* benchmark) {
+		benchmark->ArgNames({"width", "height", "move"});
+		for (const auto& [columns, rows] : BoardSizes) {
+			for (int move = static_cast<int>(Move::RotateLeft); move <= static_cast<int>(Move::GameOver); ++move) {
+				benchmark->Args({columns, rows, move});
+			}
+		}
+	}
+
+	void applyClearRowsArguments(benchmark::internal::Benchmark* benchmark) {
+		benchmark->ArgNames({"width", "height", "rows"});
+		for (const auto& [columns, rows] : BoardSizes) {
+			for (int clearedRows = 1; clearedRows <= 4; ++clearedRows) {
+				benchmark->Args({columns, rows, clearedRows});
+			}
+		}
+	}
+
+	void applyGameArguments(benchmark::internal::Benchmark* benchmark) {
+		benchmark->ArgNames({"width", "height", "depth"});
+		for (const auto& [columns, rows] : BoardSizes) {
+			for (int depth : {1, 2}) {
+				benchmark->Args({columns, rows, depth});
+			}
+		}
+	}
+
+}
+
+// Search of one board from the corpus each iteration. The transposition table is left off,
+// the corpus is repeated and would otherwise only measure the cache.
+static void calculateBestStateCorpus(benchmark::State& state) {
+	const auto boards = createBoardCorpus(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), static_cast<int>(state.range(3)));
+	const int depth = static_cast<int>(state.range(2));
+	Ai ai;
+
+	std::size_t index = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(ai.calculateBestState(boards[index], depth));
+		index = (index + 1) % boards.size();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(calculateBestStateCorpus)->Apply(applyAiArguments);
+
+// Copy of a board from the corpus at half fill and one move, compare with copyBoardCorpus.
+static void updateMove(benchmark::State& state) {
+	const auto boards = createBoardCorpus(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 50);
+	const auto move = static_cast<Move>(state.range(2));
+
+	std::size_t index = 0;
+	for (auto _ : state) {
+		TetrisBoard board = boards[index];
+		board.update(move, [](BoardEvent, int) {});
+		benchmark::DoNotOptimize(board);
+		index = (index + 1) % boards.size();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(updateMove)->Apply(applyMoveArguments);
+
+static void copyBoardCorpus(benchmark::State& state) {
+	const auto boards = createBoardCorpus(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 50);
+
+	std::size_t index = 0;
+	for (auto _ : state) {
+		TetrisBoard board = boards[index];
+		benchmark::DoNotOptimize(board);
+		index = (index + 1) % boards.size();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(copyBoardCorpus)->Apply(applyBoardSizeArguments);
+
+// Copy of the board and the block placed by gravity, clearing 1 to 4 rows.
+static void clearRows(benchmark::State& state) {
+	const auto board = createClearRowsBoard(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+
+	int removedRows = 0;
+	for (auto _ : state) {
+		TetrisBoard copy = board;
+		copy.update(Move::DownGravity, [&](BoardEvent boardEvent, int value) {
+			if (boardEvent == BoardEvent::RowsRemoved) {
+				removedRows = value;
+			}
+		});
+		benchmark::DoNotOptimize(copy);
+	}
+	if (removedRows != state.range(2)) {
+		state.SkipWithError("Wrong number of removed rows");
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(clearRows)->Apply(applyClearRowsArguments);
+
+// A whole game with seeded blocks and at most MaxGameTurns turns, the turns are the items.
+static void seededGame(benchmark::State& state) {
+	const int columns = static_cast<int>(state.range(0));
+	const int rows = static_cast<int>(state.range(1));
+	const int depth = static_cast<int>(state.range(2));
+
+	std::int64_t turns = 0;
+	for (auto _ : state) {
+		BlockGenerator blockGenerator{Seed};
+		TetrisBoard board{columns, rows, blockGenerator.generateBlockType(), blockGenerator.generateBlockType()};
+		Ai ai;
+		ai.setTranspositionTableSize(TranspositionTable::DefaultSize);
+		int gameTurns = 0;
+		while (!board.isGameOver() && gameTurns < MaxGameTurns) {
+			moveBlockToBeforeImpact(ai.calculateBestState(board, depth), board);
+			board.update(Move::DownGravity, [&](BoardEvent boardEvent, int) {
+				if (boardEvent == BoardEvent::BlockCollision) {
+					board.setNextBlock(blockGenerator.generateBlockType());
+				} else if (boardEvent == BoardEvent::CurrentBlockUpdated) {
+					++gameTurns;
+				}
+			});
+		}
+		turns += gameTurns;
+	}
+	state.SetItemsProcessed(turns);
+	state.counters["turns"] = benchmark::Counter(static_cast<double>(turns), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(seededGame)->Apply(applyGameArguments)->Unit(benchmark::kMillisecond);
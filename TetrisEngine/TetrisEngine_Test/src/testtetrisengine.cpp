@@ -1,6 +1,19 @@
 #include <gtest/gtest.h>
 
 #include <tetris/ai.h>
+#include <tetris/blockgenerator.h>
+#include <tetris/blocksequence.h>
+#include <tetris/boardkernels.h>
+#include <tetris/helper.h>
+#include <tetris/threadpool.h>
+#include <tetris/transpositiontable.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
 
 using namespace tetris;
 
@@ -196,6 +209,79 @@ TEST_F(TetrisTest, rotateBlockInBothDirection2_2) {
 	EXPECT_TRUE(blockEqual(block, rightBlock));
 }
 
+TEST_F(TetrisTest, negativeRotationsRotateRight) {
+	for (auto blockType : {BlockType::I, BlockType::J, BlockType::O, BlockType::S}) {
+		for (int rotations = 1; rotations <= 9; ++rotations) {
+			Block block{blockType, 0, 0};
+			for (int i = 0; i < rotations; ++i) {
+				block.rotateRight();
+			}
+			const Block negativeBlock{blockType, 0, 0, -rotations};
+			EXPECT_TRUE(blockEqual(negativeBlock, block));
+			EXPECT_EQ(block.getShape().minColumn, negativeBlock.getShape().minColumn);
+		}
+	}
+}
+
+TEST_F(TetrisTest, blockIsCompact) {
+	EXPECT_LE(sizeof(Block), 8u);
+}
+
+TEST_F(TetrisTest, blockRotationKeepsRotationSquare) {
+	for (auto blockType : {BlockType::I, BlockType::J, BlockType::L, BlockType::O, BlockType::S, BlockType::T, BlockType::Z}) {
+		Block block{blockType, 4, 10};
+		const auto rotationSquare = block.getRotationSquare();
+		for (int i = 0; i < 4; ++i) {
+			block.rotateLeft();
+			EXPECT_EQ(rotationSquare, block.getRotationSquare());
+		}
+		EXPECT_EQ(0, block.getCurrentRotation());
+	}
+}
+
+TEST_F(TetrisTest, blockRotateRightMatchesRotation) {
+	for (auto blockType : {BlockType::I, BlockType::S, BlockType::Z}) {
+		Block block{blockType, 4, 10};
+		EXPECT_EQ(1, block.getNumberOfRotations());
+
+		Block leftBlock = block;
+		leftBlock.rotateLeft();
+		block.rotateRight();
+		EXPECT_TRUE(blockEqual(leftBlock, block));
+		EXPECT_EQ(1, block.getCurrentRotation());
+
+		block.rotateRight();
+		EXPECT_TRUE(blockEqual(Block{blockType, 4, 10}, block));
+	}
+}
+
+TEST_F(TetrisTest, blockShapeRowMasksMatchSquares) {
+	for (auto blockType : {BlockType::I, BlockType::J, BlockType::L, BlockType::O, BlockType::S, BlockType::T, BlockType::Z}) {
+		Block block{blockType, 4, 10};
+		for (int rotation = 0; rotation <= block.getNumberOfRotations(); ++rotation, block.rotateLeft()) {
+			const auto& shape = block.getShape();
+			std::array<RowMask, 4> rowMasks{};
+			for (const auto& sq : block) {
+				const int column = sq.column - block.getStartColumn() - shape.minColumn;
+				const int row = sq.row - block.getLowestRow();
+				ASSERT_TRUE(row >= 0 && row < 4);
+				rowMasks[row] |= RowMask{1} << column;
+			}
+			EXPECT_EQ(rowMasks, shape.rowMasks);
+		}
+	}
+}
+
+TEST_F(TetrisTest, blockCreatedWithRotations) {
+	Block block{BlockType::T, 3, 7};
+	block.rotateLeft();
+	block.rotateLeft();
+	block.rotateLeft();
+
+	EXPECT_TRUE(blockEqual(block, Block{BlockType::T, 3, 7, 3}));
+	EXPECT_TRUE(blockEqual(Block{BlockType::S, 3, 7, 1}, Block{BlockType::S, 3, 7, 3}));
+}
+
 TEST_F(TetrisTest, boardIsGameOver) {
 	const BlockType firstNextBlockType = BlockType::L;
 	const BlockType firstCurrentBlockType = BlockType::S;
@@ -213,6 +299,703 @@ TEST_F(TetrisTest, boardIsGameOver) {
 	EXPECT_EQ(newBlockType, board.getNextBlockType());
 }
 
+TEST_F(TetrisTest, boardRowMasksFollowPlacedBlocks) {
+	TetrisBoard board{TetrisWidth, TetrisHeight, BlockType::O, BlockType::I};
+
+	for (int row = 0; row < TetrisHeight; ++row) {
+		EXPECT_EQ(0, board.getRowMask(row));
+	}
+
+	Block block = board.getBlock();
+	board.update(Move::DownGround);
+	board.update(Move::DownGravity);
+
+	const RowMask expected = (RowMask{1} << block.getStartColumn()) | (RowMask{1} << (block.getStartColumn() + 1));
+	EXPECT_EQ(expected, board.getRowMask(0));
+	EXPECT_EQ(expected, board.getRowMask(1));
+	EXPECT_EQ(0, board.getRowMask(2));
+	EXPECT_EQ(2, board.calculateSquaresFilled(0));
+	EXPECT_EQ(0, board.calculateSquaresFilled(TetrisHeight + 10));
+}
+
+TEST_F(TetrisTest, boardColumnsOutsideLimitThrows) {
+	constexpr int Columns = TetrisBoard::MaxColumns + 1;
+	EXPECT_THROW((TetrisBoard{Columns, TetrisHeight, BlockType::I, BlockType::L}), std::invalid_argument);
+	EXPECT_THROW((TetrisBoard{0, TetrisHeight, BlockType::I, BlockType::L}), std::invalid_argument);
+	std::vector<BlockType> rows(Columns, BlockType::Z);
+	EXPECT_THROW((TetrisBoard{rows, Columns, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::L}), std::invalid_argument);
+
+	TetrisBoard board{TetrisBoard::MaxColumns, TetrisHeight, BlockType::I, BlockType::L};
+	EXPECT_EQ(TetrisBoard::MaxColumns, board.getColumns());
+}
+
+TEST_F(TetrisTest, boardCollisionWithWallsAndSquares) {
+	std::vector<BlockType> rows(TetrisWidth, BlockType::Z);
+	rows[0] = BlockType::Empty;
+	TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::L};
+
+	EXPECT_FALSE(board.collision(Block{BlockType::I, 0, 0}));
+	EXPECT_TRUE(board.collision(Block{BlockType::I, 1, 0}));
+	EXPECT_TRUE(board.collision(Block{BlockType::I, -1, 5}));
+	EXPECT_TRUE(board.collision(Block{BlockType::I, TetrisWidth, 5}));
+	EXPECT_TRUE(board.collision(Block{BlockType::I, 0, -1}));
+	EXPECT_FALSE(board.collision(Block{BlockType::I, 0, TetrisHeight + 10}));
+}
+
+TEST_F(TetrisTest, boardRemovesFilledRow) {
+	std::vector<BlockType> rows(TetrisWidth, BlockType::Z);
+	rows[0] = BlockType::Empty;
+	rows.insert(rows.end(), TetrisWidth, BlockType::Empty);
+	rows[TetrisWidth + 0] = BlockType::T;
+	TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::L};
+
+	int rowsRemoved = 0;
+	board.update(Move::DownGround);
+	board.update(Move::DownGravity, [&](BoardEvent event, int value) {
+		if (event == BoardEvent::RowsRemoved) {
+			rowsRemoved = value;
+		}
+	});
+
+	EXPECT_EQ(0, rowsRemoved);
+
+	// Fill the hole in the lowest row with the vertical I block.
+	board = TetrisBoard{std::vector<BlockType>(rows.begin(), rows.begin() + TetrisWidth), TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::L};
+	board.update(Move::DownGround);
+	board.update(Move::DownGravity, [&](BoardEvent event, int value) {
+		if (event == BoardEvent::RowsRemoved) {
+			rowsRemoved = value;
+		}
+	});
+
+	EXPECT_EQ(1, rowsRemoved);
+	EXPECT_EQ(RowMask{1}, board.getRowMask(0));
+	EXPECT_EQ(RowMask{1}, board.getRowMask(2));
+	EXPECT_EQ(0, board.getRowMask(3));
+	EXPECT_EQ(BlockType::I, board.getBlockType(0, 0));
+	EXPECT_EQ(BlockType::Empty, board.getBlockType(1, 0));
+}
+
+TEST_F(TetrisTest, boardRemovesSeparatedRowsInOrder) {
+	// The four lowest rows filled except column 0, a hole in column 5 in row 1.
+	std::vector<BlockType> rows(4 * TetrisWidth, BlockType::Z);
+	for (int row = 0; row < 4; ++row) {
+		rows[row * TetrisWidth] = BlockType::Empty;
+	}
+	rows[TetrisWidth + 5] = BlockType::Empty;
+	TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::L};
+	board.update(Move::DownGround);
+
+	TetrisBoard placed = board;
+	TetrisBoard::PlacementUndo undo;
+	EXPECT_EQ(3, placed.applyPlacement(placed.getBlock(), undo));
+	placed.undoPlacement(undo);
+	EXPECT_EQ(board.getRowMasks(), placed.getRowMasks());
+	EXPECT_EQ(board.getBoardVector(), placed.getBoardVector());
+
+	// The same events as when removing one row at a time.
+	std::vector<std::pair<BoardEvent, int>> events;
+	board.update(Move::DownGravity, [&](BoardEvent event, int value) {
+		if (event == BoardEvent::RowToBeRemoved || event == BoardEvent::RowsRemoved) {
+			events.emplace_back(event, value);
+		}
+	});
+	const std::vector<std::pair<BoardEvent, int>> expectedEvents{
+		{BoardEvent::RowToBeRemoved, 0},
+		{BoardEvent::RowToBeRemoved, 1},
+		{BoardEvent::RowToBeRemoved, 1},
+		{BoardEvent::RowsRemoved, 3}
+	};
+	EXPECT_EQ(expectedEvents, events);
+
+	EXPECT_EQ(((RowMask{1} << TetrisWidth) - 1) & ~(RowMask{1} << 5), board.getRowMask(0));
+	EXPECT_EQ(0, board.getRowMask(1));
+	EXPECT_EQ(BlockType::I, board.getBlockType(0, 0));
+	const TetrisBoard expected{board.getBoardVector(), TetrisWidth, TetrisHeight, board.getBlock(), board.getNextBlockType()};
+	EXPECT_EQ(expected.getColumnHeights(), board.getColumnHeights());
+	EXPECT_EQ(expected.getSquaresHash(), board.getSquaresHash());
+	EXPECT_EQ(TetrisHeight, static_cast<int>(board.getRowMasks().size()));
+}
+
+TEST_F(TetrisTest, boardExternalRowsUpdateRowMasks) {
+	TetrisBoard board{TetrisWidth, TetrisHeight, BlockType::O, BlockType::I};
+	board.update(Move::DownGround);
+	board.update(Move::DownGravity);
+	const RowMask blockMask = board.getRowMask(0);
+
+	std::vector<BlockType> externalRow(TetrisWidth, BlockType::S);
+	externalRow[3] = BlockType::Empty;
+	EXPECT_EQ(1, board.addExternalRows(externalRow));
+
+	EXPECT_EQ(board.getFilledRowMask() & ~(RowMask{1} << 3), board.getRowMask(0));
+	EXPECT_EQ(blockMask, board.getRowMask(1));
+	EXPECT_EQ(blockMask, board.getRowMask(2));
+	EXPECT_EQ(9, board.calculateSquaresFilled(0));
+}
+
+TEST_F(TetrisTest, boardApplyAndUndoPlacement) {
+	std::vector<BlockType> rows(TetrisWidth, BlockType::Z);
+	rows[0] = BlockType::Empty;
+	rows.insert(rows.end(), TetrisWidth, BlockType::L);
+	rows[2 * TetrisWidth - 1] = BlockType::Empty;
+	rows[TetrisWidth] = BlockType::Empty;
+	const TetrisBoard original{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::T};
+
+	TetrisBoard board = original;
+	TetrisBoard::PlacementUndo undo;
+	EXPECT_EQ(1, board.applyPlacement(board.getBlockDown(), undo));
+
+	TetrisBoard expected = original;
+	expected.update(Move::DownGround);
+	expected.update(Move::DownGravity);
+	EXPECT_EQ(expected.getBoardVector(), board.getBoardVector());
+	EXPECT_EQ(expected.getRowMasks(), board.getRowMasks());
+	EXPECT_EQ(BlockType::T, board.getCurrentBlockType());
+
+	board.undoPlacement(undo);
+	EXPECT_EQ(original.getBoardVector(), board.getBoardVector());
+	EXPECT_EQ(original.getRowMasks(), board.getRowMasks());
+	EXPECT_TRUE(blockEqual(original.getBlock(), board.getBlock()));
+}
+
+TEST_F(TetrisTest, boardBlockDownFromColumnHeights) {
+	// Overhang in column 2 and a tower in column 7.
+	std::vector<BlockType> rows(6 * TetrisWidth, BlockType::Empty);
+	rows[0 * TetrisWidth + 0] = BlockType::Z;
+	rows[0 * TetrisWidth + 1] = BlockType::Z;
+	rows[3 * TetrisWidth + 2] = BlockType::T;
+	for (int row = 0; row < 6; ++row) {
+		rows[row * TetrisWidth + 7] = BlockType::I;
+	}
+	const TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 4, 18}, BlockType::L};
+
+	const auto& heights = board.getColumnHeights();
+	EXPECT_EQ(1, heights[0]);
+	EXPECT_EQ(4, heights[2]);
+	EXPECT_EQ(0, heights[3]);
+	EXPECT_EQ(6, heights[7]);
+
+	for (auto blockType : {BlockType::I, BlockType::J, BlockType::L, BlockType::O, BlockType::S, BlockType::T, BlockType::Z}) {
+		for (int rotation = 0; rotation < 4; ++rotation) {
+			for (int lowestStartRow : {1, 2, 18}) {
+				for (int column = -2; column < TetrisWidth + 2; ++column) {
+					const Block block{blockType, column, lowestStartRow, rotation};
+					if (board.collision(block)) {
+						continue;
+					}
+					EXPECT_TRUE(blockEqual(board.getBlockDown(block), board.getBlockDown(block, heights)));
+				}
+			}
+		}
+	}
+}
+
+TEST_F(TetrisTest, boardColumnHeightsFollowRemovedRows) {
+	// Lowest row filled except column 0, a hole in column 4.
+	std::vector<BlockType> rows(3 * TetrisWidth, BlockType::Empty);
+	for (int column = 1; column < TetrisWidth; ++column) {
+		rows[column] = BlockType::Z;
+	}
+	rows[TetrisWidth + 3] = BlockType::S;
+	rows[2 * TetrisWidth + 4] = BlockType::T;
+	TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::L};
+
+	EXPECT_EQ(2, board.getHighestUsedRow());
+	EXPECT_EQ(3, board.getColumnHeights()[4]);
+	EXPECT_EQ(2, board.getColumnHeights()[3]);
+	EXPECT_EQ(1, board.getColumnHeights()[9]);
+
+	// The vertical I block fills column 0 and removes the lowest row.
+	board.update(Move::DownGround);
+	board.update(Move::DownGravity);
+
+	const TetrisBoard expected{board.getBoardVector(), TetrisWidth, TetrisHeight, board.getBlock(), board.getNextBlockType()};
+	EXPECT_EQ(expected.getColumnHeights(), board.getColumnHeights());
+	EXPECT_EQ(expected.getHighestUsedRow(), board.getHighestUsedRow());
+	EXPECT_EQ(3, board.getColumnHeights()[0]);
+	EXPECT_EQ(2, board.getColumnHeights()[4]);
+	EXPECT_EQ(1, board.getColumnHeights()[3]);
+	EXPECT_EQ(0, board.getColumnHeights()[9]);
+	EXPECT_EQ(2, board.getHighestUsedRow());
+}
+
+TEST_F(TetrisTest, aiBoardFeaturesMatchFeatureFunctions) {
+	constexpr std::string_view Rows =
+		"EEEEEEEEEZ"
+		"EEZZEEZZZZ"
+		"ZZZZEZZZZZ"
+		"EZZZEEZZEZ"
+		"ZZZZEZZZZZ"
+		"EZZZEZZZZZ"
+		"EZZZZZEZZZ"
+		"ZZEZZEZZZZ";
+	std::vector<BlockType> rows;
+	for (int row = Rows.size() / TetrisWidth - 1; row >= 0; --row) {
+		for (char chr : Rows.substr(row * TetrisWidth, TetrisWidth)) {
+			rows.push_back(static_cast<BlockType>(chr));
+		}
+	}
+	const TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 4, 18}, BlockType::L};
+
+	const auto features = calculateBoardFeatures(board, AiParameters{true, true, true, true, true, true, true});
+	EXPECT_EQ(calculateRowTransitions(board), features.rowHoles);
+	EXPECT_EQ(calculateColumnTransitions(board), features.columnHoles);
+	EXPECT_EQ(calculateNumberOfHoles(board), features.holes);
+	EXPECT_EQ(calculateCumulativeWells(board), features.cumulativeWells);
+	EXPECT_EQ(calculateHoleDepth(board), features.holeDepth);
+	EXPECT_LT(0, features.holes);
+	EXPECT_LT(0, features.cumulativeWells);
+
+	const auto noFeatures = calculateBoardFeatures(board, AiParameters{});
+	EXPECT_EQ(0, noFeatures.rowHoles);
+	EXPECT_EQ(0, noFeatures.columnHoles);
+	EXPECT_EQ(0, noFeatures.holes);
+	EXPECT_EQ(0, noFeatures.cumulativeWells);
+	EXPECT_EQ(0, noFeatures.holeDepth);
+}
+
+TEST_F(TetrisTest, boardKernelsMatchScalarKernels) {
+	const auto& scalar = getBoardKernels(KernelType::Scalar);
+	EXPECT_EQ(KernelType::Scalar, scalar.type);
+
+	std::mt19937 random{42};
+	for (int columns : {5, 10, 17, 31, TetrisBoard::MaxColumns}) {
+		const RowMask filledRowMask = static_cast<RowMask>((std::uint64_t{1} << columns) - 1);
+		for (int size = 0; size < 40; ++size) {
+			std::vector<RowMask> rows(size);
+			for (auto& row : rows) {
+				row = static_cast<RowMask>(random()) & filledRowMask;
+			}
+
+			// Reference, one square at the time.
+			int rowTransitions = 0;
+			int holes = 0;
+			for (int y = 0; y < size; ++y) {
+				bool lastFilled = true;
+				for (int x = 0; x < columns; ++x) {
+					const bool filled = (rows[y] >> x) & 1;
+					rowTransitions += filled && !lastFilled ? 1 : 0;
+					holes += y + 1 < size && !filled && ((rows[y + 1] >> x) & 1) ? 1 : 0;
+					lastFilled = filled;
+				}
+				rowTransitions += lastFilled ? 0 : 1;
+			}
+			EXPECT_EQ(rowTransitions, scalar.rowTransitions(rows, columns));
+			EXPECT_EQ(holes, scalar.holes(rows));
+
+			for (auto type : {KernelType::Sse2, KernelType::Avx2}) {
+				if (!isKernelTypeSupported(type)) {
+					continue;
+				}
+				const auto& kernels = getBoardKernels(type);
+				EXPECT_EQ(type, kernels.type);
+				EXPECT_EQ(rowTransitions, kernels.rowTransitions(rows, columns)) << "size " << size << " columns " << columns;
+				EXPECT_EQ(holes, kernels.holes(rows)) << "size " << size << " columns " << columns;
+			}
+		}
+	}
+}
+
+TEST_F(TetrisTest, valueFunctionCompiledToPolynomial) {
+	auto valueFunction = ValueFunction::compile("-0.2*cumulativeWells - 1*holeDepth - 1*holes - 1*landingHeight");
+	ASSERT_TRUE(valueFunction.has_value());
+	EXPECT_TRUE(valueFunction->isLinear());
+	EXPECT_EQ(4u, valueFunction->getTerms().size());
+
+	AiVariables variables{};
+	variables[static_cast<int>(AiVariable::CumulativeWells)] = 5.f;
+	variables[static_cast<int>(AiVariable::HoleDepth)] = 2.f;
+	variables[static_cast<int>(AiVariable::Holes)] = 3.f;
+	variables[static_cast<int>(AiVariable::LandingHeight)] = 4.f;
+	EXPECT_FLOAT_EQ(-0.2f * 5.f - 2.f - 3.f - 4.f, valueFunction->evaluate(variables));
+
+	valueFunction = ValueFunction::compile("(holes - 2) * (holes + rows) / 2 + holes^2");
+	ASSERT_TRUE(valueFunction.has_value());
+	EXPECT_FALSE(valueFunction->isLinear());
+	variables[static_cast<int>(AiVariable::Rows)] = 20.f;
+	EXPECT_FLOAT_EQ((3.f - 2.f) * (3.f + 20.f) / 2.f + 9.f, valueFunction->evaluate(variables));
+
+	EXPECT_FALSE(ValueFunction::compile("holes / rows").has_value());
+	EXPECT_FALSE(ValueFunction::compile("holes^0.5").has_value());
+	EXPECT_FALSE(ValueFunction::compile("unknown * 2").has_value());
+	EXPECT_FALSE(ValueFunction::compile("holes +").has_value());
+}
+
+TEST_F(TetrisTest, aiUsesCompiledValueFunction) {
+	EXPECT_TRUE(Ai{}.isValueFunctionCompiled());
+	EXPECT_TRUE(Ai{"holes * rows - landingHeight"}.isValueFunctionCompiled());
+	EXPECT_FALSE(Ai{"holes / (rows - landingHeight)"}.isValueFunctionCompiled());
+}
+
+TEST_F(TetrisTest, aiBeamSearchMatchesFullSearch) {
+	constexpr std::string_view Rows =
+		"EEEEEEEEEE"
+		"ZZEEEEZZEE"
+		"ZZZZEZZZZE"
+		"ZZZZEZZZZE";
+	std::vector<BlockType> rows;
+	for (int row = Rows.size() / TetrisWidth - 1; row >= 0; --row) {
+		for (char chr : Rows.substr(row * TetrisWidth, TetrisWidth)) {
+			rows.push_back(static_cast<BlockType>(chr));
+		}
+	}
+	const TetrisBoard board{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 4, 18}, BlockType::T};
+	Ai ai;
+
+	const auto depth1 = ai.calculateBestState(board, 1);
+	const auto beamDepth1 = ai.calculateBestState(board, Ai::BeamSearch{1, 1});
+	EXPECT_EQ(depth1.left, beamDepth1.left);
+	EXPECT_EQ(depth1.rotationLeft, beamDepth1.rotationLeft);
+	EXPECT_FLOAT_EQ(depth1.value, beamDepth1.value);
+
+	// A beam wider than the number of placements keeps all boards.
+	const auto depth2 = ai.calculateBestState(board, 2);
+	const auto beamDepth2 = ai.calculateBestState(board, Ai::BeamSearch{2, 1000});
+	EXPECT_FLOAT_EQ(depth2.value, beamDepth2.value);
+}
+
+TEST_F(TetrisTest, aiDepthLargerThanTwoSearchesDepthTwo) {
+	const TetrisBoard board{TetrisWidth, TetrisHeight, BlockType::S, BlockType::Z};
+	Ai ai;
+	ThreadPool threadPool{2};
+
+	const auto depth2 = ai.calculateBestState(board, 2);
+	for (int depth : {3, 5}) {
+		const auto state = ai.calculateBestState(board, depth);
+		EXPECT_EQ(depth2.left, state.left);
+		EXPECT_EQ(depth2.rotationLeft, state.rotationLeft);
+		EXPECT_EQ(depth2.value, state.value);
+		EXPECT_EQ(depth2.value, ai.calculateBestState(board, depth, threadPool).value);
+	}
+}
+
+TEST_F(TetrisTest, aiBeamSearchBeyondNextBlock) {
+	TetrisBoard board{TetrisWidth, TetrisHeight, BlockType::S, BlockType::Z};
+	Ai ai;
+
+	for (int depth : {3, 4}) {
+		const auto state = ai.calculateBestState(board, Ai::BeamSearch{depth, 4});
+		EXPECT_LT(std::numeric_limits<float>::lowest(), state.value);
+	}
+	EXPECT_EQ(std::numeric_limits<float>::lowest(), ai.calculateBestState(board, Ai::BeamSearch{0, 4}).value);
+	EXPECT_EQ(std::numeric_limits<float>::lowest(), ai.calculateBestState(board, Ai::BeamSearch{3, 0}).value);
+
+	// Play some turns, the search must only use the board provided.
+	for (int turn = 0; turn < 20 && !board.isGameOver(); ++turn) {
+		const auto state = ai.calculateBestState(board, Ai::BeamSearch{3, Ai::DefaultBeamWidth});
+		moveBlockToBeforeImpact(state, board);
+		board.update(Move::DownGravity, [&](BoardEvent event, int) {
+			if (event == BoardEvent::BlockCollision) {
+				board.setNextBlock(turn % 2 == 0 ? BlockType::I : BlockType::O);
+			}
+		});
+	}
+	EXPECT_FALSE(board.isGameOver());
+}
+
+TEST_F(TetrisTest, threadPoolRunsAllTasks) {
+	ThreadPool threadPool{4};
+	EXPECT_EQ(4, threadPool.getThreads());
+
+	for (int tasks : {0, 1, 3, 100}) {
+		std::vector<int> calls(tasks);
+		std::vector<int> threads(tasks, -1);
+		threadPool.parallelFor(tasks, [&](int task, int thread) {
+			++calls[task];
+			threads[task] = thread;
+		});
+		EXPECT_EQ(std::vector<int>(tasks, 1), calls);
+		for (int thread : threads) {
+			EXPECT_LE(0, thread);
+			EXPECT_GT(threadPool.getThreads(), thread);
+		}
+	}
+}
+
+TEST_F(TetrisTest, aiThreadPoolSearchMatchesSearch) {
+	ThreadPool threadPool{4};
+	TetrisBoard board{TetrisWidth, TetrisHeight, BlockType::S, BlockType::Z};
+	Ai ai{"-4*holes - landingHeight - holeDepth - rowHoles - columnHoles + erodedPieces"};
+
+	for (int turn = 0; turn < 30 && !board.isGameOver(); ++turn) {
+		for (int depth : {1, 2}) {
+			const auto state = ai.calculateBestState(board, depth);
+			const auto threadState = ai.calculateBestState(board, depth, threadPool);
+			EXPECT_EQ(state.left, threadState.left);
+			EXPECT_EQ(state.rotationLeft, threadState.rotationLeft);
+			EXPECT_EQ(state.value, threadState.value);
+		}
+		const auto state = ai.calculateBestState(board, Ai::BeamSearch{3, 4});
+		const auto threadState = ai.calculateBestState(board, Ai::BeamSearch{3, 4}, threadPool);
+		EXPECT_EQ(state.left, threadState.left);
+		EXPECT_EQ(state.rotationLeft, threadState.rotationLeft);
+		EXPECT_EQ(state.value, threadState.value);
+
+		moveBlockToBeforeImpact(state, board);
+		board.update(Move::DownGravity, [&](BoardEvent event, int) {
+			if (event == BoardEvent::BlockCollision) {
+				board.setNextBlock(static_cast<BlockType>("IJLOSTZ"[turn % 7]));
+			}
+		});
+	}
+}
+
+TEST_F(TetrisTest, boardHashFollowsSquares) {
+	std::vector<BlockType> rows(TetrisWidth, BlockType::Z);
+	rows[0] = BlockType::Empty;
+	rows.insert(rows.end(), TetrisWidth, BlockType::L);
+	rows[2 * TetrisWidth - 1] = BlockType::Empty;
+	rows[TetrisWidth] = BlockType::Empty;
+	const TetrisBoard original{rows, TetrisWidth, TetrisHeight, Block{BlockType::I, 0, 10}, BlockType::O};
+	EXPECT_NE(0u, original.getSquaresHash());
+
+	// Same squares in another order.
+	const Block left = original.getBlockDown(Block{BlockType::O, 3, 18});
+	const Block right = original.getBlockDown(Block{BlockType::O, 6, 18});
+	TetrisBoard board1 = original;
+	TetrisBoard board2 = original;
+	TetrisBoard::PlacementUndo undo;
+	board1.applyPlacement(left, undo);
+	board1.applyPlacement(right, undo);
+	board2.applyPlacement(right, undo);
+	board2.applyPlacement(left, undo);
+	EXPECT_EQ(board1.getSquaresHash(), board2.getSquaresHash());
+	EXPECT_NE(original.getSquaresHash(), board1.getSquaresHash());
+
+	board2.undoPlacement(undo);
+	EXPECT_NE(board1.getSquaresHash(), board2.getSquaresHash());
+
+	// A removed row moves the squares above, same hash as a new board with the same squares.
+	TetrisBoard board = original;
+	EXPECT_EQ(1, board.applyPlacement(board.getBlockDown(), undo));
+	const TetrisBoard expected{board.getBoardVector(), TetrisWidth, TetrisHeight, board.getBlock(), BlockType::O};
+	EXPECT_EQ(expected.getSquaresHash(), board.getSquaresHash());
+	board.undoPlacement(undo);
+	EXPECT_EQ(original.getSquaresHash(), board.getSquaresHash());
+
+	// The current and next block are part of the full hash.
+	TetrisBoard other = original;
+	other.setNextBlock(BlockType::T);
+	EXPECT_EQ(original.getSquaresHash(), other.getSquaresHash());
+	EXPECT_NE(original.getHash(), other.getHash());
+}
+
+TEST_F(TetrisTest, transpositionTableReplacesValues) {
+	TranspositionTable table{1000};
+	EXPECT_EQ(1024, table.getSize());
+	EXPECT_FALSE(table.find(17).has_value());
+
+	table.insert(17, 1.5f);
+	ASSERT_TRUE(table.find(17).has_value());
+	EXPECT_EQ(1.5f, *table.find(17));
+
+	// Same slot, another key.
+	const std::uint64_t other = 17 + (std::uint64_t{5} << 40);
+	EXPECT_FALSE(table.find(other).has_value());
+	table.insert(other, -2.f);
+	EXPECT_EQ(-2.f, *table.find(other));
+	EXPECT_FALSE(table.find(17).has_value());
+
+	table.clear();
+	EXPECT_FALSE(table.find(other).has_value());
+
+	TranspositionTable empty{0};
+	empty.insert(17, 1.5f);
+	EXPECT_FALSE(empty.find(17).has_value());
+}
+
+TEST_F(TetrisTest, aiTranspositionTableKeepsStates) {
+	TetrisBoard board{TetrisWidth, TetrisHeight, BlockType::S, BlockType::Z};
+	Ai ai{"-4*holes - landingHeight - holeDepth - rowHoles - columnHoles + erodedPieces"};
+	Ai noTableAi = ai;
+	ai.setTranspositionTableSize(TranspositionTable::DefaultSize);
+
+	for (int turn = 0; turn < 40 && !board.isGameOver(); ++turn) {
+		for (int depth : {1, 2}) {
+			const auto state = ai.calculateBestState(board, depth);
+			const auto noTableState = noTableAi.calculateBestState(board, depth);
+			EXPECT_EQ(noTableState.left, state.left);
+			EXPECT_EQ(noTableState.rotationLeft, state.rotationLeft);
+			EXPECT_EQ(noTableState.value, state.value);
+		}
+		const auto beamState = ai.calculateBestState(board, Ai::BeamSearch{3, Ai::DefaultBeamWidth});
+		const auto noTableBeamState = noTableAi.calculateBestState(board, Ai::BeamSearch{3, Ai::DefaultBeamWidth});
+		EXPECT_EQ(noTableBeamState.left, beamState.left);
+		EXPECT_EQ(noTableBeamState.rotationLeft, beamState.rotationLeft);
+		EXPECT_EQ(noTableBeamState.value, beamState.value);
+		moveBlockToBeforeImpact(ai.calculateBestState(board, 2), board);
+		board.update(Move::DownGravity, [&](BoardEvent event, int) {
+			if (event == BoardEvent::BlockCollision) {
+				board.setNextBlock(static_cast<BlockType>("IJLOSTZ"[(turn * 3) % 7]));
+			}
+		});
+	}
+}
+
+TEST_F(TetrisTest, aiEarlyCutoffKeepsStates) {
+	BlockGenerator blockGenerator{3};
+	TetrisBoard board{TetrisWidth, TetrisHeight, blockGenerator.generateBlockType(), blockGenerator.generateBlockType()};
+	Ai ai{"-4*holes - landingHeight - holeDepth - rowHoles - columnHoles + erodedPieces - 0.5*cumulativeWells"};
+	Ai noCutoffAi = ai;
+	noCutoffAi.setEarlyCutoff(false);
+	EXPECT_TRUE(ai.isEarlyCutoff());
+
+	for (int turn = 0; turn < 60 && !board.isGameOver(); ++turn) {
+		for (int depth : {1, 2}) {
+			const auto state = ai.calculateBestState(board, depth);
+			const auto noCutoffState = noCutoffAi.calculateBestState(board, depth);
+			EXPECT_EQ(noCutoffState.left, state.left);
+			EXPECT_EQ(noCutoffState.rotationLeft, state.rotationLeft);
+			EXPECT_EQ(noCutoffState.value, state.value);
+		}
+		const auto beamState = ai.calculateBestState(board, Ai::BeamSearch{4, Ai::DefaultBeamWidth});
+		const auto noCutoffBeamState = noCutoffAi.calculateBestState(board, Ai::BeamSearch{4, Ai::DefaultBeamWidth});
+		EXPECT_EQ(noCutoffBeamState.left, beamState.left);
+		EXPECT_EQ(noCutoffBeamState.rotationLeft, beamState.rotationLeft);
+		EXPECT_EQ(noCutoffBeamState.value, beamState.value);
+		moveBlockToBeforeImpact(ai.calculateBestState(board, 1), board);
+		board.update(Move::DownGravity, [&](BoardEvent event, int) {
+			if (event == BoardEvent::BlockCollision) {
+				board.setNextBlock(blockGenerator.generateBlockType());
+			}
+		});
+	}
+}
+
+TEST_F(TetrisTest, boardRowsFollowClearsAndExternalRows) {
+	BlockGenerator blockGenerator{5};
+	TetrisBoard board{TetrisWidth, TetrisHeight, blockGenerator.generateBlockType(), blockGenerator.generateBlockType()};
+	Ai ai;
+	int removedRows = 0;
+
+	for (int turn = 0; turn < 150 && !board.isGameOver() && !board.collision(board.getBlock()); ++turn) {
+		if (turn % 8 == 0) {
+			board.addExternalRows(generateRow(TetrisWidth, 1, blockGenerator));
+			if (board.collision(board.getBlock())) {
+				// The external row pushed the squares into the current block.
+				break;
+			}
+		}
+		const auto state = ai.calculateBestState(board, 1);
+
+		// Undo after the rows are removed, also when the external rows are above the board.
+		TetrisBoard placed = board;
+		TetrisBoard::PlacementUndo undo;
+		moveBlockToBeforeImpact(state, placed);
+		placed.applyPlacement(placed.getBlock(), undo);
+		placed.undoPlacement(undo);
+		EXPECT_EQ(board.getRowMasks(), placed.getRowMasks());
+
+		moveBlockToBeforeImpact(state, board);
+		board.update(Move::DownGravity, [&](BoardEvent event, int value) {
+			if (event == BoardEvent::BlockCollision) {
+				board.setNextBlock(blockGenerator.generateBlockType());
+			} else if (event == BoardEvent::RowsRemoved) {
+				removedRows += value;
+			}
+		});
+
+		// The same squares as a board created from the board vector.
+		const TetrisBoard expected{board.getBoardVector(), TetrisWidth, TetrisHeight, board.getBlock(), board.getNextBlockType()};
+		for (int row = 0; row < TetrisHeight + 4; ++row) {
+			for (int column = 0; column < TetrisWidth; ++column) {
+				ASSERT_EQ(expected.getBlockType(column, row), board.getBlockType(column, row));
+			}
+		}
+		EXPECT_EQ(expected.getSquaresHash(), board.getSquaresHash());
+	}
+	EXPECT_LT(0, removedRows);
+}
+
+TEST_F(TetrisTest, blockGeneratorRepeatsSequenceFromSeed) {
+	for (auto mode : {BlockGeneratorMode::Uniform, BlockGeneratorMode::Bag7}) {
+		BlockGenerator generator1{42, mode};
+		BlockGenerator generator2{42, mode};
+		BlockGenerator other{43, mode};
+		std::vector<BlockType> sequence1;
+		std::vector<BlockType> sequence2;
+		std::vector<BlockType> otherSequence;
+		for (int i = 0; i < 70; ++i) {
+			sequence1.push_back(generator1.generateBlockType());
+			sequence2.push_back(generator2.generateBlockType());
+			otherSequence.push_back(other.generateBlockType());
+		}
+		EXPECT_EQ(sequence1, sequence2);
+		EXPECT_NE(sequence1, otherSequence);
+		EXPECT_EQ(42u, generator1.getSeed());
+
+		// The external rows of a game from a child seed repeat too.
+		BlockGenerator rows1{generator1.generateChildSeed()};
+		BlockGenerator rows2{generator2.generateChildSeed()};
+		EXPECT_EQ(generateRow(TetrisWidth, 2, rows1), generateRow(TetrisWidth, 2, rows2));
+	}
+}
+
+TEST_F(TetrisTest, blockGeneratorBagHasAllBlockTypes) {
+	BlockGenerator generator{7, BlockGeneratorMode::Bag7};
+	for (int bag = 0; bag < 20; ++bag) {
+		std::string blockTypes;
+		for (int i = 0; i < 7; ++i) {
+			blockTypes.push_back(static_cast<char>(generator.generateBlockType()));
+		}
+		std::sort(blockTypes.begin(), blockTypes.end());
+		EXPECT_EQ("IJLOSTZ", blockTypes);
+	}
+
+	BlockGenerator uniform{7, BlockGeneratorMode::Uniform};
+	std::map<BlockType, int> counts;
+	for (int i = 0; i < 7000; ++i) {
+		++counts[uniform.generateBlockType()];
+	}
+	EXPECT_EQ(7u, counts.size());
+	for (const auto& [blockType, count] : counts) {
+		EXPECT_NEAR(1000, count, 150);
+	}
+
+	Pcg32 random{1};
+	for (int i = 0; i < 1000; ++i) {
+		const int value = random.generateInt(-3, 5);
+		EXPECT_LE(-3, value);
+		EXPECT_GE(5, value);
+	}
+}
+
+TEST_F(TetrisTest, blockSequenceReadsWrittenBlocks) {
+	const auto path = (std::filesystem::temp_directory_path() / "tetris_test_blocks.bin").string();
+	const std::vector<BlockType> blockTypes{BlockType::I, BlockType::Z, BlockType::O, BlockType::T, BlockType::J, BlockType::S, BlockType::L};
+	BlockSequence::write(path, blockTypes);
+	EXPECT_TRUE(BlockSequence::hasHeader(path));
+	{
+		BlockSequence blockSequence{path};
+		ASSERT_EQ(blockTypes.size(), blockSequence.getSize());
+		for (std::size_t i = 0; i < 3 * blockTypes.size(); ++i) {
+			EXPECT_EQ(blockTypes[i % blockTypes.size()], blockSequence.getBlockType(i));
+		}
+	}
+
+	// A block type index out of range is read modulo 7.
+	std::ofstream{path, std::ios::binary} << BlockSequence::Header << '\x06' << '\x07' << '\x0a';
+	{
+		BlockSequence blockSequence{path};
+		ASSERT_EQ(3, blockSequence.getSize());
+		EXPECT_EQ(BlockType::Z, blockSequence.getBlockType(0));
+		EXPECT_EQ(BlockType::I, blockSequence.getBlockType(1));
+		EXPECT_EQ(BlockType::O, blockSequence.getBlockType(2));
+	}
+	std::ofstream{path, std::ios::binary} << BlockSequence::Header;
+	EXPECT_THROW(BlockSequence{path}, std::runtime_error);
+	std::ofstream{path} << "0 1 2";
+	EXPECT_FALSE(BlockSequence::hasHeader(path));
+	EXPECT_THROW(BlockSequence{path}, std::runtime_error);
+	std::filesystem::remove(path);
+
+	EXPECT_EQ(BlockType::I, toBlockType(0));
+	EXPECT_EQ(BlockType::Z, toBlockType(6));
+	EXPECT_EQ(BlockType::Empty, toBlockType(7));
+	EXPECT_EQ(3, toBlockTypeIndex(BlockType::O));
+	EXPECT_EQ(-1, toBlockTypeIndex(BlockType::Wall));
+}
+
 /*
 TEST_CASE("Test tetrisboard", "[tetrisboard]") {
 	INFO("Default tetrisboard");
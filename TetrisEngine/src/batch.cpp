@@ -0,0 +1,163 @@
+#include "batch.h"
+
+#include <tetris/tetrisboard.h>
+#include <tetris/blockgenerator.h>
+#include <tetris/blocksequence.h>
+#include <tetris/threadpool.h>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+
+	struct Statistics {
+		double mean;
+		double median;
+		double p5;
+		double p25;
+		double p75;
+		double p95;
+		double min;
+		double max;
+	};
+
+	// Percentile in [0, 100] of the sorted values, linear interpolation between the closest ranks.
+	double calculatePercentile(const std::vector<double>& sortedValues, double percentile) {
+		const double position = percentile / 100.0 * (sortedValues.size() - 1);
+		const auto index = static_cast<std::size_t>(position);
+		if (index + 1 >= sortedValues.size()) {
+			return sortedValues.back();
+		}
+		const double fraction = position - index;
+		return sortedValues[index] + fraction * (sortedValues[index + 1] - sortedValues[index]);
+	}
+
+	Statistics calculateStatistics(std::vector<double> values) {
+		std::sort(values.begin(), values.end());
+		return Statistics{
+			.mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size(),
+			.median = calculatePercentile(values, 50.0),
+			.p5 = calculatePercentile(values, 5.0),
+			.p25 = calculatePercentile(values, 25.0),
+			.p75 = calculatePercentile(values, 75.0),
+			.p95 = calculatePercentile(values, 95.0),
+			.min = values.front(),
+			.max = values.back()
+		};
+	}
+
+	template <typename Value>
+	void printStatistics(std::string_view name, const std::vector<GameResult>& results, Value&& value, int precision) {
+		std::vector<double> values;
+		values.reserve(results.size());
+		for (const auto& result : results) {
+			values.push_back(static_cast<double>(value(result)));
+		}
+		const auto statistics = calculateStatistics(std::move(values));
+		fmt::print("{:<16}", name);
+		for (double number : {statistics.mean, statistics.median, statistics.p5, statistics.p25,
+			statistics.p75, statistics.p95, statistics.min, statistics.max}) {
+
+			fmt::print("{:>12.{}f}", number, precision);
+		}
+		fmt::println("");
+	}
+
+}
+
+GameResult playGame(Ai& ai, const Flags& flags, std::uint64_t seed, const BlockSequence* blockSequence, std::size_t blockIndex) {
+	const auto time = std::chrono::high_resolution_clock::now();
+
+	BlockGenerator blockGenerator{seed, flags.blockGeneratorMode_};
+	auto nextBlockType = [&]() {
+		return blockSequence != nullptr ? blockSequence->getBlockType(blockIndex++) : blockGenerator.generateBlockType();
+	};
+	const auto start = nextBlockType();
+	TetrisBoard board{flags.width_, flags.height_, start, nextBlockType()};
+
+	GameResult result;
+	while (!board.isGameOver() && result.turns < flags.maxNbrBlocks_) {
+		const auto state = flags.depth_ > 2
+			? ai.calculateBestState(board, Ai::BeamSearch{flags.depth_, flags.beamWidth_})
+			: ai.calculateBestState(board, flags.depth_);
+		moveBlockToBeforeImpact(state, board);
+
+		board.update(Move::DownGravity, [&](BoardEvent boardEvent, int value) {
+			switch (boardEvent) {
+				case BoardEvent::BlockCollision:
+					board.setNextBlock(nextBlockType());
+					break;
+				case BoardEvent::CurrentBlockUpdated:
+					++result.turns;
+					break;
+				case BoardEvent::RowsRemoved:
+					++result.clearedRows[value - 1];
+					break;
+				default:
+					break;
+			}
+		});
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - time).count();
+	return result;
+}
+
+void runBatch(const Flags& flags) {
+	// Mapped once and read by all threads.
+	std::optional<BlockSequence> blockSequence;
+	if (flags.useRandomFile_) {
+		if (!BlockSequence::hasHeader(flags.randomFilePath_)) {
+			throw std::runtime_error{fmt::format("Flag --games needs a binary block file, {} is not one, see --write-file-data", flags.randomFilePath_)};
+		}
+		blockSequence.emplace(flags.randomFilePath_);
+	}
+	const std::size_t blocksPerGame = blockSequence ? std::max<std::size_t>(blockSequence->getSize() / flags.games_, 1) : 0;
+
+	ThreadPool threadPool{flags.threads_};
+
+	// The ai is not thread safe, one copy for each thread.
+	Ai ai = flags.ai_;
+	ai.setTranspositionTableSize(TranspositionTable::DefaultSize);
+	std::vector<Ai> ais(threadPool.getThreads(), ai);
+	std::vector<GameResult> results(flags.games_);
+	const std::uint64_t seed = flags.seed_.value_or(0);
+
+	const auto time = std::chrono::high_resolution_clock::now();
+	threadPool.parallelFor(flags.games_, [&](int game, int thread) {
+		results[game] = playGame(ais[thread], flags, seed + game, blockSequence ? &*blockSequence : nullptr, game * blocksPerGame);
+	});
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - time).count();
+
+	fmt::println("AI: {}", flags.ai_.getValueFunction());
+	if (blockSequence) {
+		fmt::println("Games: {}, threads: {}, blocks: {}", flags.games_, threadPool.getThreads(), flags.randomFilePath_);
+	} else {
+		fmt::println("Games: {}, threads: {}, seed: {}", flags.games_, threadPool.getThreads(), seed);
+	}
+	fmt::println("Time in seconds: {:.2f}, games per second: {:.2f}\n", seconds, flags.games_ / seconds);
+
+	fmt::print("{:<16}", "");
+	for (std::string_view column : {"mean", "median", "p5", "p25", "p75", "p95", "min", "max"}) {
+		fmt::print("{:>12}", column);
+	}
+	fmt::println("");
+	printStatistics("turns", results, [](const GameResult& result) { return result.turns; }, 1);
+	printStatistics("cleared-rows", results, [](const GameResult& result) { return result.calculateClearedRows(); }, 1);
+	for (int rows = 1; rows <= 4; ++rows) {
+		printStatistics(fmt::format("cleared-rows-{}", rows), results, [rows](const GameResult& result) {
+			return result.clearedRows[rows - 1];
+		}, 1);
+	}
+	printStatistics("time", results, [](const GameResult& result) { return result.seconds; }, 3);
+}
@@ -0,0 +1,35 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "flags.h"
+
+#include <tetris/ai.h>
+#include <tetris/blocksequence.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct GameResult {
+	int turns = 0;
+	std::array<int, 4> clearedRows{}; // Index i holds the number of times i + 1 rows were cleared at once.
+	double seconds = 0.0;
+
+	int calculateClearedRows() const {
+		return clearedRows[0] + clearedRows[1] * 2 + clearedRows[2] * 3 + clearedRows[3] * 4;
+	}
+};
+
+// Play one game with the board size, search and max turns in the flags. The blocks are read
+// from the block sequence, starting at the block index, if the block sequence is not null,
+// else generated from the seed.
+GameResult playGame(tetris::Ai& ai, const Flags& flags, std::uint64_t seed,
+	const tetris::BlockSequence* blockSequence = nullptr, std::size_t blockIndex = 0);
+
+// Play the number of games in the flags, in parallel, and print statistics of the results.
+// Game i uses the random seed, seed + i, i.e. the same flags give the same games.
+// With a binary block file, game i starts at block i * blocks / games instead.
+// Throws std::runtime_error if the block file can't be used.
+void runBatch(const Flags& flags);
+
+#endif
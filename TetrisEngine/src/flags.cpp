@@ -1,8 +1,10 @@
 #include "flags.h"
 #include "flagsexception.h"
 
+#include <charconv>
 #include <sstream>
 #include <limits>
+#include <string_view>
 
 #include <fmt/core.h>
 
@@ -19,9 +21,20 @@ namespace {
 				throw FlagsException{fmt::format("Argument {} expects a positive integer\n", str)};
 			}
 			return positiveNbr;
-		} catch (std::invalid_argument) {
+		} catch (const std::invalid_argument&) {
 			throw FlagsException{fmt::format("Argument {} expects a positive integer\n", str)};
+		} catch (const std::out_of_range&) {
+			throw FlagsException{fmt::format("Argument {} expects a positive integer\n", str)};
+		}
+	}
+
+	std::uint64_t extractArgumentSeed(std::string_view str) {
+		std::uint64_t seed = 0;
+		auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), seed);
+		if (error != std::errc{} || end != str.data() + str.size()) {
+			throw FlagsException{fmt::format("Argument {} expects a seed, an integer between 0 and {}\n", str, std::numeric_limits<std::uint64_t>::max())};
 		}
+		return seed;
 	}
 }
 
@@ -52,6 +65,34 @@ Flags::Flags(const int argc, const char* const argv[])
 			} else {
 				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
 			}
+		} else if (arg == "-w" || arg == "--beam-width") {
+			if (i + 1 < argc) {
+				beamWidth_ = extractArgumentPositiveInteger(argv[i + 1]);
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
+		} else if (arg == "-g" || arg == "--games") {
+			if (i + 1 < argc) {
+				games_ = extractArgumentPositiveInteger(argv[i + 1]);
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
+		} else if (arg == "-j" || arg == "--threads") {
+			if (i + 1 < argc) {
+				threads_ = extractArgumentPositiveInteger(argv[i + 1]);
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
+		} else if (arg == "-r" || arg == "--seed") {
+			if (i + 1 < argc) {
+				seed_ = extractArgumentSeed(argv[i + 1]);
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
 		} else if (arg == "-a" || arg == "--ai") {
 			if (i + 1 < argc) {
 				std::string valueFunction = argv[i + 1];
@@ -79,6 +120,38 @@ Flags::Flags(const int argc, const char* const argv[])
 			} else {
 				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
 			}
+		} else if (arg == "-u" || arg == "--tune") {
+			if (i + 1 < argc) {
+				tuneGenerations_ = extractArgumentPositiveInteger(argv[i + 1]);
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
+		} else if (arg == "-P" || arg == "--population") {
+			if (i + 1 < argc) {
+				population_ = extractArgumentPositiveInteger(argv[i + 1]);
+				if (population_ < 2) {
+					throw FlagsException{fmt::format("Argument with flag {}, population {} must be at least 2\n", arg, population_)};
+				}
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
+		} else if (arg == "-o" || arg == "--tune-file") {
+			if (i + 1 < argc) {
+				tuneFilePath_ = argv[i + 1];
+				++i;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
+		} else if (arg == "-W" || arg == "--write-file-data") {
+			if (i + 2 < argc) {
+				writeFilePath_ = argv[i + 1];
+				writeBlocks_ = extractArgumentPositiveInteger(argv[i + 2]);
+				i += 2;
+			} else {
+				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
+			}
 		} else if (arg == "-s" || arg == "--board-size") {
 			if (i + 2 < argc) {
 				std::stringstream stream;
@@ -87,8 +160,8 @@ Flags::Flags(const int argc, const char* const argv[])
 				stream >> width_;
 				stream >> height_;
 				i += 2;
-				if (width_ < 5 || width_ > 99) {
-					throw FlagsException{fmt::format("Argument with flag {}, width {} must be within [5, 99]\n", arg, width_)};
+				if (width_ < 5 || width_ > TetrisBoard::MaxColumns) {
+					throw FlagsException{fmt::format("Argument with flag {}, width {} must be within [5, {}]\n", arg, width_, TetrisBoard::MaxColumns)};
 				}
 				if (height_ < 5 || height_ > 99) {
 					throw FlagsException{fmt::format("Argument with flag {}, height {} must be within [5, 99]\n", arg, width_)};
@@ -96,6 +169,8 @@ Flags::Flags(const int argc, const char* const argv[])
 			} else {
 				throw FlagsException{fmt::format("Missing argument after {} flag\n", arg)};
 			}
+		} else if (arg == "-b" || arg == "--bag") {
+			blockGeneratorMode_ = BlockGeneratorMode::Bag7;
 		} else if (arg == "-v" || arg == "--verbose") {
 			verbose_ = true;
 		} else if (arg == "-p" || arg == "--play") {
@@ -133,9 +208,13 @@ void Flags::printHelpFunction() const {
 	fmt::println("\t{} -d <DELAY>", programName_);
 	fmt::println("\t{} -a <VALUE_FUNCTION>", programName_);
 	fmt::println("\t{} -D <DEPTH>", programName_);
+	fmt::println("\t{} -D <DEPTH> -w <BEAM_WIDTH>", programName_);
 	fmt::println("\t{} -m <MAX_TURNS>", programName_);
 	fmt::println("\t{} -f <FILE>", programName_);
-	fmt::println("\t{} -s <WIDTH> <HEIGHT>\n", programName_);
+	fmt::println("\t{} -W <FILE> <BLOCKS>", programName_);
+	fmt::println("\t{} -u <GENERATIONS> -P <POPULATION> -o <FILE>", programName_);
+	fmt::println("\t{} -s <WIDTH> <HEIGHT>", programName_);
+	fmt::println("\t{} -g <GAMES> -j <THREADS> -r <SEED>\n", programName_);
 
 	Ai ai{};
 	fmt::println("\tDefault ai value function is \"{}\"", ai.getValueFunction());
@@ -155,19 +234,36 @@ void Flags::printHelpFunction() const {
 	fmt::println("\tS = 4");
 	fmt::println("\tT = 5");
 	fmt::println("\tZ = 6");
-	fmt::println("\tExample of data in file is \"0 2 0 7 1 3\".");
-	fmt::println("\tWhen the simulation has used the whole file, it start to read from the beginning again, and so on.\n");
+	fmt::println("\tExample of data in file is \"0 2 0 6 1 3\".");
+	fmt::println("\tWhen the simulation has used the whole file, it start to read from the beginning again, and so on.");
+	fmt::println("\tThe file can also be a binary file, written by the -W flag, with one byte for each block.");
+	fmt::println("\tThe binary file is memory mapped and is shared by all threads when using the -g flag,");
+	fmt::println("\tgame i starts at block i * blocks / games.\n");
 
 	fmt::println("Options: ");
 	fmt::println("\t-h --help                show this help");
 	fmt::println("\t-d --delay               delay in milliseconds between each turn");
 	fmt::println("\t-a --ai-function         define the value function to be use by the ai");
-	fmt::println("\t-D --depth               the search depth for the ai (0, 1 or 2), default is 1");
+	fmt::println("\t-D --depth               the search depth for the ai, default is 1");
+	fmt::println("\t                         a depth larger than 2 uses beam search");
+	fmt::println("\t-w --beam-width          the number of boards kept at each depth in the beam search, default is {}", Ai::DefaultBeamWidth);
 	fmt::println("\t-m --max-turns           define the max number of turns");
 	fmt::println("\t-f --file-data           use random data from a file");
+	fmt::println("\t-W --write-file-data     write a binary file of blocks and exit, use the -r and -b flags");
 	fmt::println("\t-s --board-size          define the size of the board");
 	fmt::println("\t-v --verbose             show additional info");
 	fmt::println("\t-p --play                show board each turn");
+	fmt::println("\t-g --games               play a number of games and print statistics of the results");
+	fmt::println("\t-j --threads             the number of threads playing games, default is the number of cores");
+	fmt::println("\t-r --seed                the random seed of the blocks, default is a new seed each game");
+	fmt::println("\t                         with --games, game i uses seed + i, default seed is 0");
+	fmt::println("\t-b --bag                 generate the blocks in bags of all seven block types");
+	fmt::println("\t-u --tune                tune the weights of the linear terms in the ai value function,");
+	fmt::println("\t                         for a number of generations, each candidate plays the same --games");
+	fmt::println("\t                         (default 10) seeded games of at most --max-turns (default 1000)");
+	fmt::println("\t-P --population          the number of candidates in each tune generation, default is 32");
+	fmt::println("\t-o --tune-file           save the tune progress and best value function to the file after");
+	fmt::println("\t                         each generation, continue from the file if it exists");
 	fmt::println("");
 	fmt::println("\tOutput order:");
 	fmt::println("\t-T --time                print the time lapsed");
@@ -186,5 +282,15 @@ void Flags::printHelpFunction() const {
 	fmt::println("\t{} --play -d 250\n", programName_);
 
 	fmt::println("\tList the time and number of four-rows cleared.");
-	fmt::println("\t{} -T --cleared-row-4", programName_);
+	fmt::println("\t{} -T --cleared-row-4\n", programName_);
+
+	fmt::println("\tPlay 1000 games of at most 500 turns on 8 threads.");
+	fmt::println("\t{} --games 1000 --threads 8 -m 500\n", programName_);
+
+	fmt::println("\tWrite ten million blocks to a binary file and play 1000 games using the file.");
+	fmt::println("\t{} -W blocks.bin 10000000 -r 1", programName_);
+	fmt::println("\t{} -f blocks.bin --games 1000 -m 10000\n", programName_);
+
+	fmt::println("\tTune the default value function for 50 generations, saving the progress to tune.txt.");
+	fmt::println("\t{} --tune 50 --tune-file tune.txt", programName_);
 }
@@ -2,10 +2,14 @@
 #define FLAGS_H
 
 #include <tetris/ai.h>
+#include <tetris/blockgenerator.h>
 #include <calc/calculatorexception.h>
 
 #include <chrono>
+#include <cstdint>
+#include <optional>
 #include <queue>
+#include <thread>
 
 class Flags {
 public:
@@ -20,6 +24,8 @@ public:
 	int maxNbrBlocks_;
 	tetris::Ai ai_;
 	std::string randomFilePath_;
+	std::string writeFilePath_;
+	std::string tuneFilePath_;
 	std::queue<std::string> outputOrder_;
 	
 	std::chrono::milliseconds delay_{0};
@@ -30,6 +36,14 @@ public:
 	int height_ = 24;
 	bool verbose_ = false;
 	int depth_ = 1;
+	int beamWidth_ = tetris::Ai::DefaultBeamWidth;
+	int games_ = 0;
+	int writeBlocks_ = 0;
+	int tuneGenerations_ = 0;
+	int population_ = 32;
+	int threads_ = static_cast<int>(std::thread::hardware_concurrency());
+	std::optional<std::uint64_t> seed_;
+	tetris::BlockGeneratorMode blockGeneratorMode_ = tetris::BlockGeneratorMode::Uniform;
 };
 
 #endif
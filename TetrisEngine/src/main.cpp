@@ -1,14 +1,20 @@
+#include "batch.h"
 #include "flags.h"
 #include "flagsexception.h"
+#include "tune.h"
 
 #include <tetris/tetrisboard.h>
+#include <tetris/blockgenerator.h>
+#include <tetris/blocksequence.h>
 #include <tetris/helper.h>
 #include <tetris/ai.h>
 #include <calc/calculatorexception.h>
 
 #include <fmt/core.h>
 
+#include <charconv>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <thread>
 #include <limits>
@@ -16,6 +22,10 @@
 #include <thread>
 #include <chrono>
 #include <iomanip>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace std::chrono_literals;
 using namespace tetris;
@@ -30,47 +40,67 @@ BlockType badRandomBlockType() {
 	return blockType;
 }
 
-BlockType readBlockType(std::ifstream& infile) {
-	int data = -1;
-	if (infile.is_open()) {
-		if (!(infile >> data)) {
-			// Restart, read from the start again.
-			infile.clear();
-			infile.seekg(0, std::ios::beg);
-			infile >> data;
+// Return the numbers in the text file, other characters are ignored. Return nothing if the
+// file can't be read or holds no numbers.
+std::optional<std::vector<int>> readBlockIndexes(const std::string& path) {
+	std::ifstream infile{path};
+	if (!infile.is_open()) {
+		return std::nullopt;
+	}
+	const std::string text{std::istreambuf_iterator<char>{infile}, std::istreambuf_iterator<char>{}};
+	if (infile.bad()) {
+		return std::nullopt;
+	}
+
+	std::vector<int> indexes;
+	const char* it = text.data();
+	const char* end = text.data() + text.size();
+	while (it != end) {
+		if (*it < '0' || *it > '9') {
+			++it;
+			continue;
 		}
+		int index = -1;
+		auto [ptr, error] = std::from_chars(it, end, index);
+		// A number out of range is not a block type.
+		indexes.push_back(error == std::errc{} ? index : -1);
+		it = ptr;
 	}
-	if (data >= 0 && data <= 6) {
-		return static_cast<BlockType>(data);
+	if (indexes.empty()) {
+		return std::nullopt;
+	}
+	return indexes;
+}
+
+BlockType readBlockType(const std::vector<int>& blockIndexes, std::size_t index) {
+	if (auto blockType = toBlockType(blockIndexes[index % blockIndexes.size()]); blockType != BlockType::Empty) {
+		return blockType;
 	}
 	// In order for the ai to fail.
 	return badRandomBlockType();
 }
 
 struct Tetris {
-	Tetris(TetrisBoard& tetrisBoard, const Flags& flags, std::ifstream& infile)
+	Tetris(TetrisBoard& tetrisBoard, const Flags& flags, const std::vector<int>& fileBlockIndexes, BlockGenerator& blockGenerator,
+		const BlockSequence* blockSequence = nullptr, std::size_t blockIndex = 0)
 		: tetrisBoard{tetrisBoard}
 		, flags{flags}
-		, infile{infile} {
+		, fileBlockIndexes{fileBlockIndexes}
+		, blockGenerator{blockGenerator}
+		, blockSequence{blockSequence}
+		, blockIndex{blockIndex} {
 	}
 	
 	void operator()(BoardEvent gameEvent, int value) {
 		switch (gameEvent) {
 			case tetris::BoardEvent::BlockCollision:
-				if (flags.useRandomFile_) {
-					try {
-						BlockType blockType = readBlockType(infile);
-						tetrisBoard.setNextBlock(blockType);
-					} catch (const std::ifstream::failure& e) {
-
-						fmt::println(stderr, "Failed to read {}", flags.randomFilePath_);
-						if (flags.verbose_) {
-							fmt::println(stderr, "{}", e.what());
-						}
-						std::exit(1);
-					}
+				if (blockSequence != nullptr) {
+					tetrisBoard.setNextBlock(blockSequence->getBlockType(blockIndex++));
+				} else if (!fileBlockIndexes.empty()) {
+					// Start from the beginning again after the last block type.
+					tetrisBoard.setNextBlock(readBlockType(fileBlockIndexes, blockIndex++));
 				} else {
-					tetrisBoard.setNextBlock(randomBlockType());
+					tetrisBoard.setNextBlock(blockGenerator.generateBlockType());
 				}
 				break;
 			case tetris::BoardEvent::CurrentBlockUpdated:
@@ -107,7 +137,10 @@ struct Tetris {
 
 	TetrisBoard& tetrisBoard;
 	Flags flags;
-	std::ifstream& infile;
+	const std::vector<int>& fileBlockIndexes;
+	BlockGenerator& blockGenerator;
+	const BlockSequence* blockSequence;
+	std::size_t blockIndex;
 	int turns{};
 	int clearedOneRows{};
 	int clearedTwoRows{};
@@ -116,7 +149,7 @@ struct Tetris {
 };
 
 void printBoard(const TetrisBoard& board) {
-	const std::vector<BlockType>& squares = board.getBoardVector();
+	const std::vector<BlockType> squares = board.getBoardVector();
 	int rows = board.getRows();
 	int columns = board.getColumns();
 	Block block = board.getBlock();
@@ -213,6 +246,18 @@ void printGameResult(const Tetris& tetris, const Flags& flags, const std::chrono
 	fmt::println("");
 }
 
+void writeBlockSequence(const Flags& flags) {
+	BlockGenerator blockGenerator{flags.seed_ ? *flags.seed_ : BlockGenerator::generateSeed(), flags.blockGeneratorMode_};
+	std::vector<BlockType> blockTypes(flags.writeBlocks_);
+	for (auto& blockType : blockTypes) {
+		blockType = blockGenerator.generateBlockType();
+	}
+	BlockSequence::write(flags.writeFilePath_, blockTypes);
+	if (flags.verbose_) {
+		fmt::println("Wrote {} blocks to {}, seed: {}", blockTypes.size(), flags.writeFilePath_, blockGenerator.getSeed());
+	}
+}
+
 void runGame(Tetris& tetris) {
 	auto time = std::chrono::high_resolution_clock::now();
 
@@ -220,9 +265,12 @@ void runGame(Tetris& tetris) {
 	auto& tetrisBoard = tetris.tetrisBoard;
 
 	Ai ai = flags.ai_;
+	ai.setTranspositionTableSize(TranspositionTable::DefaultSize);
 	TetrisBoard playBoard{tetrisBoard};
 	while (!tetrisBoard.isGameOver() && tetris.turns < flags.maxNbrBlocks_) {
-		auto state = ai.calculateBestState(tetrisBoard, flags.depth_);
+		auto state = flags.depth_ > 2
+			? ai.calculateBestState(tetrisBoard, Ai::BeamSearch{flags.depth_, flags.beamWidth_})
+			: ai.calculateBestState(tetrisBoard, flags.depth_);
 
 		if (flags.play_) {
 			fmt::println("AI: {}", ai.getValueFunction());
@@ -266,29 +314,57 @@ int main(const int argc, const char* const argv[]) {
 		return 0;
 	}
 
-	auto start = randomBlockType();
-	auto next = randomBlockType();
+	try {
+		if (!flags.writeFilePath_.empty()) {
+			writeBlockSequence(flags);
+			return 0;
+		}
+		if (flags.tuneGenerations_ > 0) {
+			runTune(flags);
+			return 0;
+		}
+		if (flags.games_ > 0) {
+			runBatch(flags);
+			return 0;
+		}
+	} catch (const std::runtime_error& e) {
+		fmt::println(stderr, "{}", e.what());
+		return 1;
+	}
 
-	std::ifstream infile;
-	infile.exceptions(std::ifstream::badbit| std::ifstream::failbit);
+	BlockGenerator blockGenerator{flags.seed_ ? *flags.seed_ : BlockGenerator::generateSeed(), flags.blockGeneratorMode_};
+	if (flags.verbose_) {
+		fmt::println("Seed: {}", blockGenerator.getSeed());
+	}
+	auto start = blockGenerator.generateBlockType();
+	auto next = blockGenerator.generateBlockType();
 
-	if (flags.useRandomFile_) {
+	std::vector<int> fileBlockIndexes;
+	std::optional<BlockSequence> blockSequence;
+	if (flags.useRandomFile_ && BlockSequence::hasHeader(flags.randomFilePath_)) {
 		try {
-			infile.open(flags.randomFilePath_);
-		} catch (const std::ifstream::failure& e) {
-			fmt::println(stderr, "Failed to open file: {}", flags.randomFilePath_);
-			if (flags.verbose_) {
-				fmt::println(stderr, "{}", e.what());
-			}
+			blockSequence.emplace(flags.randomFilePath_);
+		} catch (const std::runtime_error& e) {
+			fmt::println(stderr, "{}", e.what());
+			std::exit(1);
+		}
+		start = blockSequence->getBlockType(0);
+		next = blockSequence->getBlockType(1);
+	} else if (flags.useRandomFile_) {
+		// The text file is parsed once, the game reads the block types from memory.
+		auto blockIndexes = readBlockIndexes(flags.randomFilePath_);
+		if (!blockIndexes) {
+			fmt::println(stderr, "Failed to read block types from file: {}", flags.randomFilePath_);
 			std::exit(1);
 		}
-		start = readBlockType(infile);
-		next = readBlockType(infile);
+		fileBlockIndexes = std::move(*blockIndexes);
+		start = readBlockType(fileBlockIndexes, 0);
+		next = readBlockType(fileBlockIndexes, 1);
 	}
 
 	TetrisBoard tetrisBoard{flags.width_, flags.height_, start, next};
 
-	Tetris tetris{tetrisBoard, flags, infile};
+	Tetris tetris{tetrisBoard, flags, fileBlockIndexes, blockGenerator, blockSequence ? &*blockSequence : nullptr, 2};
 
 	runGame(tetris);
 	
@@ -0,0 +1,333 @@
+#include "tune.h"
+#include "batch.h"
+
+#include <tetris/blockgenerator.h>
+#include <tetris/threadpool.h>
+#include <tetris/valuefunction.h>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+
+	// The tuned variables are the first in AiVariable, rows and columns are the same in all games.
+	constexpr int TunedVariables = static_cast<int>(AiVariable::HoleDepth) + 1;
+
+	constexpr int DefaultGames = 10;
+	constexpr int DefaultMaxTurns = 1000;
+	constexpr double EliteFraction = 0.25;
+	constexpr double InitialDeviation = 1.0;
+	// Added to the variance of the elite, divided by the generation number. Keeps the
+	// distribution from collapsing before a good mean is found.
+	constexpr double NoiseVariance = 0.1;
+
+	using Weights = std::array<double, TunedVariables>;
+
+	// The games each candidate plays, a continued run must play the same games.
+	struct TuneGames {
+		int population = 0;
+		int games = 0;
+		int maxTurns = 0;
+		std::uint64_t seed = 0;
+
+		bool operator==(const TuneGames&) const = default;
+	};
+
+	struct TuneState {
+		int generation = 0;
+		TuneGames games;
+		Weights mean{};
+		Weights deviation{};
+		double bestFitness = -std::numeric_limits<double>::infinity();
+		Weights best{};
+	};
+
+	std::string toValueFunction(const Weights& weights) {
+		std::string valueFunction;
+		for (int i = 0; i < TunedVariables; ++i) {
+			if (weights[i] == 0.0) {
+				continue;
+			}
+			if (valueFunction.empty()) {
+				valueFunction = fmt::format("{:.4f}*{}", weights[i], AiVariableNames[i]);
+			} else {
+				valueFunction += fmt::format(" {} {:.4f}*{}", weights[i] < 0.0 ? '-' : '+', std::abs(weights[i]), AiVariableNames[i]);
+			}
+		}
+		return valueFunction.empty() ? "0" : valueFunction;
+	}
+
+	std::string tunedVariableNames() {
+		std::string names = AiVariableNames[0];
+		for (int i = 1; i < TunedVariables; ++i) {
+			names += fmt::format(", {}", AiVariableNames[i]);
+		}
+		return names;
+	}
+
+	std::string toString(const ValueFunction::Term& term) {
+		auto text = fmt::format("{}", term.coefficient);
+		for (int i = 0; i < term.degree; ++i) {
+			text += fmt::format("*{}", AiVariableNames[term.variables[i]]);
+		}
+		return text;
+	}
+
+	// Standard normal numbers by the Box-Muller transform. Unlike std::normal_distribution, the
+	// numbers are the same with every standard library.
+	class NormalGenerator {
+	public:
+		NormalGenerator(std::uint64_t seed, std::uint64_t stream)
+			: random_{seed, stream} {
+		}
+
+		double operator()() {
+			if (spare_) {
+				return *std::exchange(spare_, std::nullopt);
+			}
+			constexpr double Range = static_cast<double>(Pcg32::max()) + 1.0;
+			// In (0, 1], the logarithm is finite.
+			const double u1 = (random_() + 1.0) / Range;
+			const double u2 = random_() / Range;
+			const double radius = std::sqrt(-2.0 * std::log(u1));
+			const double angle = 2.0 * std::numbers::pi * u2;
+			spare_ = radius * std::sin(angle);
+			return radius * std::cos(angle);
+		}
+
+	private:
+		Pcg32 random_;
+		std::optional<double> spare_;
+	};
+
+	TuneState createState(const Ai& ai, const TuneGames& games) {
+		const auto valueFunction = ValueFunction::compile(ai.getValueFunction());
+		if (!valueFunction) {
+			throw std::runtime_error{fmt::format("Tuning needs a polynomial value function, not \"{}\"", ai.getValueFunction())};
+		}
+		TuneState state;
+		state.games = games;
+		for (const auto& term : valueFunction->getTerms()) {
+			if (term.degree != 1 || term.variables[0] >= TunedVariables) {
+				throw std::runtime_error{fmt::format("Tuning only supports a weight times one of {}, not the term {} in \"{}\"",
+					tunedVariableNames(), toString(term), ai.getValueFunction())};
+			}
+			state.mean[term.variables[0]] += term.coefficient;
+		}
+		state.deviation.fill(InitialDeviation);
+		return state;
+	}
+
+	void writeWeights(std::ofstream& file, const char* name, const Weights& weights) {
+		file << name;
+		for (double weight : weights) {
+			file << ' ' << weight;
+		}
+		file << '\n';
+	}
+
+	bool readWeights(std::ifstream& file, const char* name, Weights& weights) {
+		std::string key;
+		if (!(file >> key) || key != name) {
+			return false;
+		}
+		for (double& weight : weights) {
+			if (!(file >> weight)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool readVariables(std::ifstream& file) {
+		std::string key;
+		if (!(file >> key) || key != "variables") {
+			return false;
+		}
+		for (int i = 0; i < TunedVariables; ++i) {
+			if (!(file >> key) || key != AiVariableNames[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool readGames(std::ifstream& file, TuneGames& games) {
+		std::string key;
+		return file >> key && key == "population" && file >> games.population
+			&& file >> key && key == "games" && file >> games.games
+			&& file >> key && key == "max-turns" && file >> games.maxTurns
+			&& file >> key && key == "seed" && file >> games.seed;
+	}
+
+	std::optional<TuneState> loadState(const std::string& path) {
+		std::ifstream file{path};
+		if (!file.is_open()) {
+			return std::nullopt;
+		}
+
+		TuneState state;
+		std::string key;
+		const bool valid = file >> key && key == "generation" && file >> state.generation
+			&& readGames(file, state.games)
+			&& readVariables(file)
+			&& readWeights(file, "mean", state.mean)
+			&& readWeights(file, "deviation", state.deviation)
+			&& file >> key && key == "best-fitness" && file >> state.bestFitness
+			&& readWeights(file, "best", state.best);
+		if (!valid) {
+			throw std::runtime_error{fmt::format("Failed to read tune file {}", path)};
+		}
+		return state;
+	}
+
+	// Write to a temporary file first, an interrupted run keeps the last complete generation.
+	void saveState(const std::string& path, const TuneState& state) {
+		const auto tmpPath = path + ".tmp";
+		{
+			std::ofstream file{tmpPath};
+			file << std::setprecision(std::numeric_limits<double>::max_digits10);
+			file << "generation " << state.generation << '\n';
+			file << "population " << state.games.population << '\n';
+			file << "games " << state.games.games << '\n';
+			file << "max-turns " << state.games.maxTurns << '\n';
+			file << "seed " << state.games.seed << '\n';
+			file << "variables";
+			for (int i = 0; i < TunedVariables; ++i) {
+				file << ' ' << AiVariableNames[i];
+			}
+			file << '\n';
+			writeWeights(file, "mean", state.mean);
+			writeWeights(file, "deviation", state.deviation);
+			file << "best-fitness " << state.bestFitness << '\n';
+			writeWeights(file, "best", state.best);
+			file << "ai " << toValueFunction(state.best) << '\n';
+			if (!file) {
+				throw std::runtime_error{fmt::format("Failed to write tune file {}", tmpPath)};
+			}
+		}
+		std::filesystem::rename(tmpPath, path);
+	}
+
+}
+
+void runTune(const Flags& flags) {
+	if (flags.useRandomFile_) {
+		throw std::runtime_error{"Flag --tune uses seeded games and can not be combined with --file-data"};
+	}
+	Flags gameFlags = flags;
+	if (gameFlags.maxNbrBlocks_ == std::numeric_limits<int>::max()) {
+		// A good value function may never lose.
+		gameFlags.maxNbrBlocks_ = DefaultMaxTurns;
+	}
+	const int games = flags.games_ > 0 ? flags.games_ : DefaultGames;
+	const int population = flags.population_;
+	const int elites = std::max(1, static_cast<int>(std::lround(population * EliteFraction)));
+	const std::uint64_t seed = flags.seed_.value_or(0);
+	const TuneGames tuneGames{population, games, gameFlags.maxNbrBlocks_, seed};
+
+	auto state = flags.tuneFilePath_.empty() ? std::nullopt : loadState(flags.tuneFilePath_);
+	if (state) {
+		if (state->games != tuneGames) {
+			throw std::runtime_error{fmt::format("Tune file {} is from a run with population {}, games {}, max turns {} and seed {}",
+				flags.tuneFilePath_, state->games.population, state->games.games, state->games.maxTurns, state->games.seed)};
+		}
+		fmt::println("Continue from generation {} in {}", state->generation, flags.tuneFilePath_);
+	} else {
+		state = createState(flags.ai_, tuneGames);
+	}
+
+	fmt::println("Population: {}, elites: {}, games: {}, max turns: {}, seed: {}",
+		population, elites, games, gameFlags.maxNbrBlocks_, seed);
+
+	ThreadPool threadPool{flags.threads_};
+	std::vector<Weights> candidates(population);
+	std::vector<std::string> valueFunctions(population);
+	std::vector<Ai> ais;
+	ais.reserve(population);
+	std::vector<int> clearedRows(population * games);
+	std::vector<double> fitness(population);
+	std::vector<int> order(population);
+
+	while (state->generation < flags.tuneGenerations_) {
+		// Seeded by the generation, i.e. a continued run samples the same candidates.
+		NormalGenerator normal{seed, static_cast<std::uint64_t>(state->generation)};
+		ais.clear();
+		for (int candidate = 0; candidate < population; ++candidate) {
+			for (int i = 0; i < TunedVariables; ++i) {
+				candidates[candidate][i] = state->mean[i] + state->deviation[i] * normal();
+			}
+			valueFunctions[candidate] = toValueFunction(candidates[candidate]);
+			ais.emplace_back(valueFunctions[candidate]);
+		}
+
+		// All candidates play the same games. The ai is not thread safe, each game plays with a copy.
+		threadPool.parallelFor(population * games, [&](int task, int) {
+			Ai ai = ais[task / games];
+			clearedRows[task] = playGame(ai, gameFlags, seed + task % games).calculateClearedRows();
+		});
+
+		for (int candidate = 0; candidate < population; ++candidate) {
+			const auto begin = clearedRows.begin() + candidate * games;
+			fitness[candidate] = std::accumulate(begin, begin + games, 0.0) / games;
+		}
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			return fitness[a] > fitness[b];
+		});
+
+		if (fitness[order[0]] > state->bestFitness) {
+			state->bestFitness = fitness[order[0]];
+			state->best = candidates[order[0]];
+		}
+
+		const double noise = NoiseVariance / (state->generation + 1);
+		for (int i = 0; i < TunedVariables; ++i) {
+			double mean = 0.0;
+			for (int elite = 0; elite < elites; ++elite) {
+				mean += candidates[order[elite]][i];
+			}
+			mean /= elites;
+			double variance = 0.0;
+			for (int elite = 0; elite < elites; ++elite) {
+				variance += (candidates[order[elite]][i] - mean) * (candidates[order[elite]][i] - mean);
+			}
+			state->mean[i] = mean;
+			state->deviation[i] = std::sqrt(variance / elites + noise);
+		}
+		++state->generation;
+
+		fmt::println("Generation {}: best {:.1f}, elite {:.1f}, population {:.1f}, cleared rows on average",
+			state->generation, fitness[order[0]],
+			std::accumulate(order.begin(), order.begin() + elites, 0.0, [&](double sum, int candidate) {
+				return sum + fitness[candidate];
+			}) / elites,
+			std::accumulate(fitness.begin(), fitness.end(), 0.0) / population);
+		if (flags.verbose_) {
+			fmt::println("\tbest: {}", valueFunctions[order[0]]);
+			fmt::println("\tmean: {}", toValueFunction(state->mean));
+		}
+
+		if (!flags.tuneFilePath_.empty()) {
+			saveState(flags.tuneFilePath_, *state);
+		}
+	}
+
+	fmt::println("Best value function, {:.1f} cleared rows on average:", state->bestFitness);
+	fmt::println("{}", toValueFunction(state->best));
+}
@@ -0,0 +1,18 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+#include "flags.h"
+
+// Tune the weights of the ai value function with the noisy cross entropy method. Each
+// generation samples a population of weights from a normal distribution, plays the same
+// seeded games with each candidate, in parallel, and moves the distribution towards the
+// best candidates.
+//
+// The weights start from the ai value function in the flags, which must be a sum of weights
+// times the tuned variables. Progress is saved to the tune file after each generation and a run
+// continues from the file if it exists. Throws std::runtime_error if the value function has
+// another term, if the tune file can't be read or written, or if it is from a run with another
+// population, number of games, max turns or seed.
+void runTune(const Flags& flags);
+
+#endif
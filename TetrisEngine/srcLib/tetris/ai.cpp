@@ -1,37 +1,130 @@
 #include "ai.h"
+#include "boardkernels.h"
+#include "threadpool.h"
+#include "valuefunction.h"
+#include "zobrist.h"
 
 #include <calc/cache.h>
 #include <calc/calculatorexception.h>
 
 #include <limits>
 #include <cmath>
+#include <bit>
+#include <span>
+#include <algorithm>
+#include <optional>
 
 namespace tetris {
 
 	namespace {
 
-		// Calculate and return all possible states for the block provided.
-		std::vector<Ai::State> calculateAllPossibleStates(const TetrisBoard& board, Block block) {
-			std::vector<Ai::State> states;
+		// Max number of rotations (including the duplicated default rotation) times max number of columns.
+		constexpr int MaxPlacements = 5 * TetrisBoard::MaxColumns;
 
+		struct Placement {
+			Ai::State state;
+			Block block; // The block at ground, before impact.
+		};
+
+		// Fixed capacity buffer, in order to not allocate memory during the search.
+		class Placements {
+		public:
+			void push_back(const Placement& placement) {
+				placements_[size_++] = placement;
+			}
+
+			const Placement* begin() const {
+				return placements_.data();
+			}
+
+			const Placement* end() const {
+				return placements_.data() + size_;
+			}
+
+			int size() const {
+				return size_;
+			}
+
+			const Placement& operator[](int index) const {
+				return placements_[index];
+			}
+
+			void clear() {
+				size_ = 0;
+			}
+
+		private:
+			std::array<Placement, MaxPlacements> placements_;
+			int size_ = 0;
+		};
+
+		void moveIfNoCollision(const TetrisBoard& board, Block& block, Move move) {
+			Block moved = block;
+			switch (move) {
+				case Move::RotateLeft:
+					moved.rotateLeft();
+					break;
+				case Move::Left:
+					moved.moveLeft();
+					break;
+				case Move::Right:
+					moved.moveRight();
+					break;
+				default:
+					break;
+			}
+			if (!board.collision(moved)) {
+				block = moved;
+			}
+		}
+
+		// Same result as moveBlockToBeforeImpact, but without updating a board.
+		Block calculateBlockBeforeImpact(const TetrisBoard& board, const TetrisBoard::ColumnHeights& heights, Block block, const Ai::State& state) {
+			for (int i = 0; i < state.rotationLeft; ++i) {
+				moveIfNoCollision(board, block, Move::RotateLeft);
+			}
+			for (int i = 0; i < state.left; ++i) {
+				moveIfNoCollision(board, block, Move::Left);
+			}
+			for (int i = 0; i < -1 * state.left; ++i) {
+				moveIfNoCollision(board, block, Move::Right);
+			}
+			return board.getBlockDown(block, heights);
+		}
+
+		// Calculate all possible placements for the block provided. The landing row for each
+		// placement is calculated from the column heights, no moves are simulated.
+		void calculateAllPossibleStates(const TetrisBoard& board, Block block, Placements& placements) {
 			// Valid block position?
 			if (!board.collision(block)) {
+				const auto& heights = board.getColumnHeights();
+				const Block start = block;
+
+				// The rotation reached when each rotation is blocked by collisions, as when the moves are performed.
+				Block rotated = block;
+
 				// Go through all rotations for the block.
 				for (int rotationLeft = 0; rotationLeft <= block.getNumberOfRotations(); ++rotationLeft, block.rotateLeft()) {
+					if (rotationLeft > 0) {
+						moveIfNoCollision(board, rotated, Move::RotateLeft);
+					}
+					const bool rotationReached = rotated.getCurrentRotation() == block.getCurrentRotation();
+
+					auto addPlacement = [&](const Ai::State& state, const Block& horizontal) {
+						if (rotationReached) {
+							placements.push_back(Placement{state, board.getBlockDown(horizontal, heights)});
+						} else {
+							placements.push_back(Placement{state, calculateBlockBeforeImpact(board, heights, start, state)});
+						}
+					};
+
 					// Go left.
 					Block horizontal = block;
 					horizontal.moveLeft();
 
 					int stepsLeft = 1;
 					while (!board.collision(horizontal)) { // Go left until obstacle.
-						Block vertical = horizontal;
-						int stepsDown = 1;
-						vertical.moveDown();
-						while (!board.collision(vertical)) {
-							++stepsDown;
-							vertical.moveDown();
-						}
-						states.push_back(Ai::State{stepsLeft, rotationLeft});
+						addPlacement(Ai::State{stepsLeft, rotationLeft}, horizontal);
 
 						++stepsLeft;
 						horizontal.moveLeft();
@@ -41,21 +134,61 @@ namespace tetris {
 
 					horizontal = block;
 					while (!board.collision(horizontal)) { // Go right until obstacle.
-						Block vertical = horizontal;
-						int stepsDown = 1;
-						vertical.moveDown();
-						while (!board.collision(vertical)) {
-							++stepsDown;
-							vertical.moveDown();
-						}
-						states.push_back(Ai::State{stepsLeft, rotationLeft});
+						addPlacement(Ai::State{stepsLeft, rotationLeft}, horizontal);
 
 						--stepsLeft;
 						horizontal.moveRight();
 					}
 				}
 			}
-			return states;
+		}
+
+		constexpr std::array<BlockType, 7> BlockTypes{
+			BlockType::I, BlockType::J, BlockType::L, BlockType::O, BlockType::S, BlockType::T, BlockType::Z
+		};
+
+		// Same position as a new current block on the board.
+		Block createStartBlock(const TetrisBoard& board, BlockType blockType) {
+			return Block{blockType, board.getColumns() / 2 - 1, board.getRows() - 4};
+		}
+
+		// A board kept in the beam, after the placements leading to it.
+		struct BeamNode {
+			TetrisBoard board;
+			Ai::State rootState{}; // The placement of the current block leading to the board.
+			int parent = 0;
+			int group = 0; // Block type index of the placement, 0 if the block is known.
+			float value = std::numeric_limits<float>::lowest();
+
+			// Per group of children, the best value of the evaluated children and the best
+			// value of the children kept in the beam.
+			int groups = 0;
+			std::array<float, BlockTypes.size()> evaluatedValues{};
+			std::array<float, BlockTypes.size()> keptValues{};
+		};
+
+		struct BeamCandidate {
+			int parent;
+			int group;
+			Ai::State state;
+			Block block;
+			float value;
+		};
+
+		// The value of the best child for each group, using the value from deeper levels
+		// for the children kept in the beam. Several groups give the expected value.
+		float calculateBeamNodeValue(const BeamNode& node) {
+			float sum = 0.f;
+			for (int group = 0; group < node.groups; ++group) {
+				const bool kept = node.keptValues[group] != std::numeric_limits<float>::lowest();
+				const float value = kept ? node.keptValues[group] : node.evaluatedValues[group];
+				if (value == std::numeric_limits<float>::lowest()) {
+					// Game over for at least one block type.
+					return value;
+				}
+				sum += value;
+			}
+			return node.groups > 0 ? sum / node.groups : node.value;
 		}
 
 		inline int factorial(int number) {
@@ -71,6 +204,30 @@ namespace tetris {
 			return "-0.2*cumulativeWells - 1*holeDepth - 1*holes - 1*landingHeight";
 		}
 
+		std::uint64_t calculateBoardSizeKey(const TetrisBoard& board) {
+			return zobrist::mix((static_cast<std::uint64_t>(board.getRows()) << 32) | static_cast<std::uint32_t>(board.getColumns()));
+		}
+
+		// Key of the value of the block placed at ground on the board, independent of the board
+		// before the block was moved there.
+		std::uint64_t calculatePlacementKey(const TetrisBoard& board, const Block& block) {
+			const std::uint64_t blockBits = static_cast<unsigned char>(block.getBlockType())
+				| static_cast<std::uint64_t>(block.getCurrentRotation()) << 8
+				| static_cast<std::uint64_t>(static_cast<std::uint16_t>(block.getStartColumn())) << 16
+				| static_cast<std::uint64_t>(static_cast<std::uint16_t>(block.getLowestStartRow())) << 32;
+			return zobrist::mix(board.getSquaresHash() ^ zobrist::mix(blockBits) ^ calculateBoardSizeKey(board));
+		}
+
+		// Key of the best value for the current block, at the start position, on the board.
+		std::uint64_t calculateChildKey(const TetrisBoard& board) {
+			return zobrist::mix(board.getSquaresHash() ^ zobrist::blockTypeKey(board.getCurrentBlockType(), 2) ^ calculateBoardSizeKey(board));
+		}
+
+		// Return the row masks from the lowest row to the highest used row.
+		std::span<const RowMask> usedRowMasks(const TetrisBoard& board) {
+			return std::span{board.getRowMasks()}.first(board.getHighestUsedRow() + 1);
+		}
+
 	}
 
 	RowRoughness calculateRowRoughness(const TetrisBoard& board, int highestUsedRow) {
@@ -125,9 +282,11 @@ namespace tetris {
 	// Calculate the cleared lines times the current blocks square contribution to the cleared lines. 
 	// Calculation is perfomed before the block is part of the board.
 	int calculateErodedPieces(const TetrisBoard& board) { // f2
+		return calculateErodedPieces(board, board.getBlock());
+	}
+
+	int calculateErodedPieces(const TetrisBoard& board, const Block& block) {
 		int w = board.getColumns();
-		int h = board.getRows();
-		const Block& block = board.getBlock();
 
 		int clearedLines = 0;
 		int contribution = 0;
@@ -151,89 +310,33 @@ namespace tetris {
 
 	// Calculate the number of filled cells adjacent to empty cells summed of all rows.
 	int calculateRowTransitions(const TetrisBoard& board) { // f3
-		const int w = board.getColumns();
-		const int h = board.getRows();
-		const auto highestRow = calculateHighestUsedRow(board);
-
-		int holes = 0;
-		for (int y = 0; y <= highestRow; ++y) {
-			bool lastFilled = true; // Left wall counts as filled.
-			for (int x = 0; x < w; ++x) {
-				bool filled = board.getBlockType(x, y) != BlockType::Empty;
-				if (lastFilled != filled && filled) {
-					++holes;
-				}
-				lastFilled = filled;
-			}
-			if (!lastFilled) {
-				++holes;
-			}
-		}
-		return holes;
+		return getBoardKernels().rowTransitions(usedRowMasks(board), board.getColumns());
 	}
 
 	// Calculate the number of filled cells adjacent to empty cells summed of all columns.
 	int calculateColumnTransitions(const TetrisBoard& board) { // f4
-		const int w = board.getColumns();
-		const int h = board.getRows();
-		const auto highestRow = calculateHighestUsedRow(board) + 1; // One higher, should be a empty square.
-
-		int holes = 0;
-		for (int x = 0; x < w; ++x) {
-			bool lastFilled = true; // Upper limit counts as filled.
-			for (int y = 0; y <= highestRow; ++y) {
-				bool filled = board.getBlockType(x, y) != BlockType::Empty;
-				if (lastFilled != filled && filled) {
-					++holes;
-				}
-				lastFilled = filled;
-			}
-			if (!lastFilled) {
-				++holes;
-			}
-		}
-		return holes;
+		// Each hole starts a transition, and each column ends with a transition to the empty square above.
+		return getBoardKernels().holes(usedRowMasks(board)) + board.getColumns();
 	}
 
 	// Calculate the number of holes, the number of empty cells with at least one filled cell above.
 	int calculateNumberOfHoles(const TetrisBoard& board) { // f5
-		const auto w = board.getColumns();
-		const auto h = board.getRows();
-		const auto highestRow = calculateHighestUsedRow(board);
-
-		int holes = 0;
-		for (int x = 0; x < w; ++x) {
-			bool foundFirstFilled = false; // Is always empty at the top. No hole.
-			bool lastEmpty = false;
-			for (int y = highestRow; y >= 0; --y) {
-				bool empty = board.getBlockType(x, y) == BlockType::Empty;
-				if (!empty) {
-					foundFirstFilled = true;
-				}
-				if (empty && foundFirstFilled && !lastEmpty) {
-					++holes;
-				}
-				lastEmpty = empty;
-			}
-		}
-		return holes;
+		return getBoardKernels().holes(usedRowMasks(board));
 	}
 
 	// Calculate the sum of the accumulated depths of the wells.
 	int calculateCumulativeWells(const TetrisBoard& board) { // f6
 		auto w = board.getColumns();
-		auto h = board.getRows();
-		const auto highestRow = calculateHighestUsedRow(board);
+		const auto& heights = board.getColumnHeights();
 
 		int cumulativeWells = 0;
 		for (int x = 0; x < w; ++x) {
+			// Only the empty squares above the column and below the lowest neighbor column can be part of a well.
+			const int leftHeight = x > 0 ? heights[x - 1] : std::numeric_limits<int>::max();
+			const int rightHeight = x < w - 1 ? heights[x + 1] : std::numeric_limits<int>::max();
 			int cumulative = 0;
-			for (int y = highestRow; y >= 0; --y) {
-				bool empty = board.getBlockType(x, y) == BlockType::Empty;
+			for (int y = std::min(leftHeight, rightHeight) - 1; y >= heights[x]; --y) {
 				bool neighborsFilled = board.getBlockType(x - 1, y) != BlockType::Empty && board.getBlockType(x + 1, y) != BlockType::Empty;
-				if (!empty) {
-					break;
-				}
 				if (neighborsFilled) {
 					++cumulative;
 				}
@@ -249,13 +352,12 @@ namespace tetris {
 	// Calculate the number of filled cells above holes summed over all columns.
 	int calculateHoleDepth(const TetrisBoard& board) { // f7
 		int w = board.getColumns();
-		int h = board.getRows();
-		const auto highestRow = calculateHighestUsedRow(board);
+		const auto& heights = board.getColumnHeights();
 
 		int filled = 0;
 		for (int x = 0; x < w; ++x) {
 			bool foundEmpty = false;
-			for (int y = 0; y <= highestRow; ++y) {
+			for (int y = 0; y < heights[x]; ++y) {
 				bool empty = board.getBlockType(x, y) == BlockType::Empty;
 				if (empty) {
 					foundEmpty = true;
@@ -268,45 +370,91 @@ namespace tetris {
 		return filled;
 	}
 
-	namespace {
+	// Calculate the number of rows containing at least one hole.
+	int calculateRowHoles(const TetrisBoard& board) { // f8
+		const auto highestRow = board.getHighestUsedRow();
 
-		bool isAtLeastOneFilledSquareAbowe(int x, int y, const TetrisBoard& board, size_t highestRow) {
-			for (++y; y <= highestRow; ++y) {
-				if (board.getBlockType(x, y) != BlockType::Empty) {
-					return true;
-				}
+		int rows = 0;
+		RowMask filledAbove = 0; // Columns with at least one filled square above the row.
+		for (int y = highestRow; y >= 0; --y) {
+			const RowMask rowMask = board.getRowMask(y);
+			if ((filledAbove & ~rowMask) != 0) {
+				++rows;
 			}
-			return false;
+			filledAbove |= rowMask;
 		}
-
+		return rows;
 	}
 
-	// Calculate the number of rows containing at least one hole.
-	int calculateRowHoles(const TetrisBoard& board) { // f8
-		int w = board.getColumns();
-		int h = board.getRows();
-		const auto highestRow = calculateHighestUsedRow(board);
+	AiFeatures calculateBoardFeatures(const TetrisBoard& board, const AiParameters& parameters) {
+		const int w = board.getColumns();
+		const RowMask filledRowMask = board.getFilledRowMask();
+		const RowMask leftWall = RowMask{1};
+		const RowMask rightWall = RowMask{1} << (w - 1);
 
-		int rows = 0;
-		for (int y = 0; y <= highestRow; ++y) {
-			for (int x = 0; x < w; ++x) {
-				bool empty = board.getBlockType(x, y) == BlockType::Empty;
-				if (empty && isAtLeastOneFilledSquareAbowe(x, y, board, highestRow)) {
-					++rows;
-					break;
+		AiFeatures features{};
+
+		// Row transitions and holes are whole board kernels over the row masks.
+		const auto& kernels = getBoardKernels();
+		const auto rowMasks = usedRowMasks(board);
+		if (parameters.rowHoles) {
+			features.rowHoles = kernels.rowTransitions(rowMasks, w);
+		}
+		if (parameters.columnHoles || parameters.holes) {
+			const int holes = kernels.holes(rowMasks);
+			features.holes = parameters.holes ? holes : 0;
+			features.columnHoles = parameters.columnHoles ? holes + w : 0;
+		}
+		if (!parameters.holeDepth && !parameters.cumulativeWells) {
+			return features;
+		}
+
+		// Per column state, the squares of column x are in bit x of the row masks.
+		std::array<int, TetrisBoard::MaxColumns> filledInColumn{};
+		std::array<int, TetrisBoard::MaxColumns> holeDepth{};
+		std::array<int, TetrisBoard::MaxColumns> wellDepth{};
+		RowMask filledAbove = 0;
+		RowMask wellStarted = 0;
+		RowMask wellEnded = 0;
+
+		// From the top, one row at a time.
+		for (int y = static_cast<int>(rowMasks.size()) - 1; y >= 0; --y) {
+			const RowMask row = rowMasks[y];
+			const RowMask empty = ~row & filledRowMask;
+
+			if (parameters.holeDepth) {
+				for (RowMask columns = empty & filledAbove; columns != 0; columns &= columns - 1) {
+					const int x = std::countr_zero(columns);
+					holeDepth[x] = filledInColumn[x];
+				}
+				for (RowMask columns = row; columns != 0; columns &= columns - 1) {
+					++filledInColumn[std::countr_zero(columns)];
 				}
 			}
+			if (parameters.cumulativeWells) {
+				// Empty squares above the column, the first run from the top with both neighbors filled is the well.
+				const RowMask neighborsFilled = ((row << 1) | leftWall) & ((row >> 1) | rightWall);
+				const RowMask active = empty & ~filledAbove & ~wellEnded;
+				wellEnded |= active & ~neighborsFilled & wellStarted;
+				const RowMask wells = active & neighborsFilled;
+				wellStarted |= wells;
+				for (RowMask columns = wells; columns != 0; columns &= columns - 1) {
+					++wellDepth[std::countr_zero(columns)];
+				}
+			}
+
+			filledAbove |= row;
 		}
-		return rows;
+
+		for (int x = 0; x < w; ++x) {
+			features.holeDepth += holeDepth[x];
+			features.cumulativeWells += factorial(wellDepth[x]);
+		}
+		return features;
 	}
 
 	int calculateHighestUsedRow(const TetrisBoard& board) {
-		const auto& v = board.getBoardVector();
-		auto it = std::find_if(v.rbegin(), v.rend(), [](BlockType blockType) {
-			return BlockType::Empty != blockType;
-		});
-		auto index = it - v.rbegin();
-		return static_cast<int>((v.size() - index - 1) / board.getColumns());
+		return board.getHighestUsedRow();
 	}
 
 	float calculateBlockMeanHeight(const Block& block) {
@@ -338,44 +486,44 @@ namespace tetris {
 	}
 
 	Ai::State Ai::calculateBestState(const TetrisBoard& board, int depth) {
-		calculator_.updateVariable("rows", (float) board.getRows());
-		calculator_.updateVariable("columns", (float) board.getColumns());
+		updateBoardVariables(board);
+
+		// The only copy during the search, placements are applied and undone on this board.
+		TetrisBoard searchBoard{board};
 		if (depth >= 2) {
-			return calculateBestStateRecursive(board, 2);
+			return calculateBestStateRecursive(searchBoard, 2);
 		} else if (depth == 1) {
-			return calculateBestStateRecursive(board, 1);
+			return calculateBestStateRecursive(searchBoard, 1);
 		} else {
-			return calculateBestStateRecursive(board, 0);
+			return calculateBestStateRecursive(searchBoard, 0);
 		}
 	}
 
-	Ai::State Ai::calculateBestStateRecursive(const TetrisBoard& board, int depth) {
+	Ai::State Ai::calculateBestStateRecursive(TetrisBoard& board, int depth, float bound) {
 		Ai::State bestState;
 
 		if (depth > 0) {
-			std::vector<Ai::State> states = calculateAllPossibleStates(board, board.getBlock());
-
-			for (const auto& state : states) {
-				TetrisBoard childBoard{board};
+			Placements placements;
+			calculateAllPossibleStates(board, board.getBlock(), placements);
 
+			TetrisBoard::PlacementUndo undo;
+			for (const auto& [state, block] : placements) {
 				if (depth == 2) {
-					moveBlockToBeforeImpact(state, childBoard);
-
 					// Impact, the block is now a part of the board.
-					childBoard.update(Move::DownGravity);
-
-					State childState = calculateBestStateRecursive(childBoard, 1);
+					board.applyPlacement(block, undo);
+					const float childValue = calculateChildValue(board, std::max(bound, bestState.value));
+					board.undoPlacement(undo);
 
-					if (childState.value > bestState.value) {
+					if (childValue > bestState.value) {
 						bestState = state;
 						// Only updating the value from the child.
-						bestState.value = childState.value;
+						bestState.value = childValue;
 					}
 				} else {
-					float value = moveBlockToGroundCalculateValue(state, childBoard);
-					if (value > bestState.value) {
+					const auto value = calculatePlacementValue(board, block, std::max(bound, bestState.value));
+					if (value && *value > bestState.value) {
 						bestState = state;
-						bestState.value = value;
+						bestState.value = *value;
 					}
 				}
 			}
@@ -383,44 +531,326 @@ namespace tetris {
 		return bestState;
 	}
 
+	Ai::State Ai::calculateBestState(const TetrisBoard& board, const BeamSearch& beamSearch) {
+		updateBoardVariables(board);
+		if (beamSearch.depth <= 0 || beamSearch.width <= 0) {
+			return State{};
+		}
+		return calculateBestStateBeamSearch(board, beamSearch, nullptr);
+	}
+
+	Ai::State Ai::calculateBestState(const TetrisBoard& board, int depth, ThreadPool& threadPool) {
+		updateBoardVariables(board);
+		if (depth <= 0) {
+			return State{};
+		}
+		depth = std::min(depth, 2);
+
+		Placements placements;
+		calculateAllPossibleStates(board, board.getBlock(), placements);
+
+		// Each root placement is a task, with one board and one ai for each thread.
+		auto& threadAis = updateThreadAis(board, threadPool.getThreads());
+		std::vector<TetrisBoard> searchBoards(threadPool.getThreads(), board);
+		std::array<float, MaxPlacements> values;
+		threadPool.parallelFor(placements.size(), [&](int task, int thread) {
+			auto& searchBoard = searchBoards[thread];
+			const auto& block = placements[task].block;
+			if (depth == 2) {
+				TetrisBoard::PlacementUndo undo;
+				searchBoard.applyPlacement(block, undo);
+				values[task] = threadAis[thread].calculateChildValue(searchBoard);
+				searchBoard.undoPlacement(undo);
+			} else {
+				values[task] = threadAis[thread].calculatePlacementValue(searchBoard, block);
+			}
+		});
+
+		// Same order as without threads, for the same result.
+		State bestState;
+		for (int i = 0; i < placements.size(); ++i) {
+			if (values[i] > bestState.value) {
+				bestState = placements[i].state;
+				bestState.value = values[i];
+			}
+		}
+		return bestState;
+	}
+
+	Ai::State Ai::calculateBestState(const TetrisBoard& board, const BeamSearch& beamSearch, ThreadPool& threadPool) {
+		updateBoardVariables(board);
+		if (beamSearch.depth <= 0 || beamSearch.width <= 0) {
+			return State{};
+		}
+		return calculateBestStateBeamSearch(board, beamSearch, &threadPool);
+	}
+
+	Ai::State Ai::calculateBestStateBeamSearch(const TetrisBoard& board, const BeamSearch& beamSearch, ThreadPool* threadPool) {
+		constexpr float Lowest = std::numeric_limits<float>::lowest();
+
+		// Level 0 is the board provided, level i holds the boards after i placements.
+		std::vector<std::vector<BeamNode>> levels;
+		levels.reserve(beamSearch.depth);
+		levels.push_back({BeamNode{board}});
+
+		std::vector<BeamCandidate> candidates;
+		std::vector<std::vector<BeamCandidate>> parentCandidates;
+		for (int level = 1; level <= beamSearch.depth; ++level) {
+			// Only the current and the next block are known.
+			const bool known = level <= 2;
+			auto& parents = levels.back();
+
+			// Evaluate the placements of one parent, on the board of the parent.
+			auto expand = [&](int parent, Ai& evaluator, std::vector<BeamCandidate>& parentCandidates) {
+				auto& node = parents[parent];
+				node.groups = known ? 1 : static_cast<int>(BlockTypes.size());
+				node.evaluatedValues.fill(Lowest);
+				node.keptValues.fill(Lowest);
+
+				Placements placements;
+				for (int group = 0; group < node.groups; ++group) {
+					const Block block = known ? node.board.getBlock() : createStartBlock(node.board, BlockTypes[group]);
+					placements.clear();
+					calculateAllPossibleStates(node.board, block, placements);
+
+					std::optional<BeamCandidate> best;
+					for (const auto& [state, blockDown] : placements) {
+						// All placements of a known block are candidates, of an unknown block only the best.
+						const auto value = known
+							? evaluator.calculatePlacementValue(node.board, blockDown)
+							: evaluator.calculatePlacementValue(node.board, blockDown, node.evaluatedValues[group]);
+						if (!value) {
+							continue;
+						}
+						if (known) {
+							parentCandidates.push_back(BeamCandidate{parent, group, state, blockDown, *value});
+						}
+						if (*value > node.evaluatedValues[group]) {
+							node.evaluatedValues[group] = *value;
+							best = BeamCandidate{parent, group, state, blockDown, *value};
+						}
+					}
+					// An unknown block is placed at its best placement, i.e. one child per block type.
+					if (!known && best) {
+						parentCandidates.push_back(*best);
+					}
+				}
+			};
+
+			candidates.clear();
+			if (threadPool != nullptr) {
+				// Each parent is a task, the candidates are merged in the same order as without threads.
+				auto& threadAis = updateThreadAis(board, threadPool->getThreads());
+				parentCandidates.resize(parents.size());
+				threadPool->parallelFor(static_cast<int>(parents.size()), [&](int parent, int thread) {
+					parentCandidates[parent].clear();
+					expand(parent, threadAis[thread], parentCandidates[parent]);
+				});
+				for (int parent = 0; parent < static_cast<int>(parents.size()); ++parent) {
+					candidates.insert(candidates.end(), parentCandidates[parent].begin(), parentCandidates[parent].end());
+				}
+			} else {
+				for (int parent = 0; parent < static_cast<int>(parents.size()); ++parent) {
+					expand(parent, *this, candidates);
+				}
+			}
+
+			if (level == 1 && beamSearch.depth == 1) {
+				// No deeper level, the placement with the highest value is the best.
+				State bestState;
+				for (const auto& candidate : candidates) {
+					if (candidate.value > bestState.value) {
+						bestState = candidate.state;
+						bestState.value = candidate.value;
+					}
+				}
+				return bestState;
+			}
+			if (level == beamSearch.depth) {
+				break;
+			}
+
+			// Prune by the value of the placement, keep the order of the placements for equal values.
+			const auto width = std::min(static_cast<std::size_t>(beamSearch.width), candidates.size());
+			std::stable_sort(candidates.begin(), candidates.end(), [](const BeamCandidate& left, const BeamCandidate& right) {
+				return left.value > right.value;
+			});
+
+			std::vector<BeamNode> children;
+			children.reserve(width);
+			TetrisBoard::PlacementUndo undo;
+			for (std::size_t i = 0; i < width; ++i) {
+				const auto& candidate = candidates[i];
+				const auto& parent = parents[candidate.parent];
+				auto& child = children.emplace_back(BeamNode{parent.board});
+				child.board.applyPlacement(candidate.block, undo);
+				child.rootState = level == 1 ? candidate.state : parent.rootState;
+				child.parent = candidate.parent;
+				child.group = candidate.group;
+				child.value = candidate.value;
+			}
+			levels.push_back(std::move(children));
+		}
+
+		// Update the values from the deepest level up to the children of the board provided.
+		for (int level = static_cast<int>(levels.size()) - 1; level >= 1; --level) {
+			for (auto& node : levels[level]) {
+				node.value = calculateBeamNodeValue(node);
+				auto& keptValue = levels[level - 1][node.parent].keptValues[node.group];
+				keptValue = std::max(keptValue, node.value);
+			}
+		}
+
+		State bestState;
+		for (const auto& node : levels[1]) {
+			if (node.value > bestState.value) {
+				bestState = node.rootState;
+				bestState.value = node.value;
+			}
+		}
+		return bestState;
+	}
+
+	void Ai::setTranspositionTableSize(int size) {
+		transpositionTable_ = TranspositionTable{size};
+		threadAis_.clear();
+	}
+
+	std::vector<Ai>& Ai::updateThreadAis(const TetrisBoard& board, int threads) {
+		if (static_cast<int>(threadAis_.size()) != threads) {
+			Ai ai{valueFunction_};
+			ai.transpositionTable_ = TranspositionTable{transpositionTable_.getSize()};
+			ai.earlyCutoff_ = earlyCutoff_;
+			threadAis_.assign(threads, ai);
+		}
+		for (auto& ai : threadAis_) {
+			ai.updateBoardVariables(board);
+		}
+		return threadAis_;
+	}
+
+	void Ai::updateBoardVariables(const TetrisBoard& board) {
+		variables_[static_cast<int>(AiVariable::Rows)] = (float) board.getRows();
+		variables_[static_cast<int>(AiVariable::Columns)] = (float) board.getColumns();
+		updateCalculatorVariables();
+	}
+
 	float Ai::moveBlockToGroundCalculateValue(const State& state, TetrisBoard& board) {
 		moveBlockToBeforeImpact(state, board);
-		if (parameters_.landingHeight) {
-			calculator_.updateVariable("landingHeight", (float) calculateLandingHeight(board.getBlock()));
+		const float value = evaluatePlacement(board, board.getBlock());
+		// Make the variables of the placement visible in the calculator.
+		updateCalculatorVariables();
+		return value;
+	}
+
+	float Ai::calculatePlacementValue(TetrisBoard& board, const Block& block) {
+		return *calculatePlacementValue(board, block, std::numeric_limits<float>::lowest());
+	}
+
+	std::optional<float> Ai::calculatePlacementValue(TetrisBoard& board, const Block& block, float bound) {
+		if (transpositionTable_.getSize() == 0) {
+			return evaluatePlacement(board, block, bound);
+		}
+		const auto key = calculatePlacementKey(board, block);
+		if (auto value = transpositionTable_.find(key)) {
+			return *value;
 		}
-		if (parameters_.erodedPieces) {
-			calculator_.updateVariable("erodedPieces", (float) calculateErodedPieces(board));
+		const auto value = evaluatePlacement(board, block, bound);
+		// Only exact values are stored.
+		if (value) {
+			transpositionTable_.insert(key, *value);
+		}
+		return value;
+	}
+
+	float Ai::calculateChildValue(TetrisBoard& board, float bound) {
+		if (transpositionTable_.getSize() == 0) {
+			return calculateBestStateRecursive(board, 1, bound).value;
 		}
-		board.update(Move::DownGround);
-		if (parameters_.rowHoles) {
-			calculator_.updateVariable("rowHoles", (float) calculateRowTransitions(board));
+		const auto key = calculateChildKey(board);
+		if (auto value = transpositionTable_.find(key)) {
+			return *value;
 		}
-		if (parameters_.columnHoles) {
-			calculator_.updateVariable("columnHoles", (float) calculateColumnTransitions(board));
+		const float value = calculateBestStateRecursive(board, 1, bound).value;
+		if (value > bound || bound == std::numeric_limits<float>::lowest()) {
+			transpositionTable_.insert(key, value);
 		}
-		if (parameters_.holes) {
-			calculator_.updateVariable("holes", (float) calculateNumberOfHoles(board));
+		return value;
+	}
+
+	float Ai::evaluatePlacement(TetrisBoard& board, const Block& block) {
+		// Nothing is cut off without a bound.
+		return *evaluatePlacement(board, block, std::numeric_limits<float>::lowest());
+	}
+
+	std::optional<float> Ai::evaluatePlacement(TetrisBoard& board, const Block& block, float bound) {
+		const bool cutoff = earlyCutoff_ && bound != std::numeric_limits<float>::lowest();
+
+		// The features not yet calculated are zero. When their weights are not positive, and the
+		// features are never negative, the value is an upper bound of the final value.
+		auto isCutOff = [&](bool cutoffAllowed) {
+			return cutoff && cutoffAllowed && compiledValueFunction_->evaluate(variables_) <= bound;
+		};
+
+		// The cheap features first, from the block before impact.
+		variables_[static_cast<int>(AiVariable::LandingHeight)] = parameters_.landingHeight ? (float) calculateLandingHeight(block) : 0.f;
+		variables_[static_cast<int>(AiVariable::ErodedPieces)] = parameters_.erodedPieces ? (float) calculateErodedPieces(board, block) : 0.f;
+		variables_[static_cast<int>(AiVariable::RowHoles)] = 0.f;
+		variables_[static_cast<int>(AiVariable::ColumnHoles)] = 0.f;
+		variables_[static_cast<int>(AiVariable::Holes)] = 0.f;
+		variables_[static_cast<int>(AiVariable::CumulativeWells)] = 0.f;
+		variables_[static_cast<int>(AiVariable::HoleDepth)] = 0.f;
+		if (isCutOff(cutoffAfterBlock_)) {
+			return std::nullopt;
 		}
-		if (parameters_.cumulativeWells) {
-			calculator_.updateVariable("cumulativeWells", (float) calculateCumulativeWells(board));
+
+		// The board features are from the board without the block, the value functions are tuned for it.
+		AiFeatures features;
+		if (cutoff && cutoffAfterHoles_) {
+			// The board kernels before the scan over the rows.
+			AiParameters parameters = parameters_;
+			parameters.cumulativeWells = false;
+			parameters.holeDepth = false;
+			features = calculateBoardFeatures(board, parameters);
+			variables_[static_cast<int>(AiVariable::RowHoles)] = (float) features.rowHoles;
+			variables_[static_cast<int>(AiVariable::ColumnHoles)] = (float) features.columnHoles;
+			variables_[static_cast<int>(AiVariable::Holes)] = (float) features.holes;
+			if (isCutOff(true)) {
+				return std::nullopt;
+			}
+			parameters = AiParameters{};
+			parameters.cumulativeWells = parameters_.cumulativeWells;
+			parameters.holeDepth = parameters_.holeDepth;
+			const auto scanFeatures = calculateBoardFeatures(board, parameters);
+			features.cumulativeWells = scanFeatures.cumulativeWells;
+			features.holeDepth = scanFeatures.holeDepth;
+		} else {
+			features = calculateBoardFeatures(board, parameters_);
 		}
-		if (parameters_.holeDepth) {
-			calculator_.updateVariable("holeDepth", (float) calculateHoleDepth(board));
+
+		variables_[static_cast<int>(AiVariable::RowHoles)] = (float) features.rowHoles;
+		variables_[static_cast<int>(AiVariable::ColumnHoles)] = (float) features.columnHoles;
+		variables_[static_cast<int>(AiVariable::Holes)] = (float) features.holes;
+		variables_[static_cast<int>(AiVariable::CumulativeWells)] = (float) features.cumulativeWells;
+		variables_[static_cast<int>(AiVariable::HoleDepth)] = (float) features.holeDepth;
+
+		if (compiledValueFunction_) {
+			return compiledValueFunction_->evaluate(variables_);
 		}
+		updateCalculatorVariables();
 		return calculator_.excecute(cache_);
 	}
 
-	void Ai::initCalculator(bool allowException) {
-		calculator_.addVariable("landingHeight", 0);
-		calculator_.addVariable("erodedPieces", 0);
-		calculator_.addVariable("rowHoles", 0);
-		calculator_.addVariable("columnHoles", 0);
-		calculator_.addVariable("holes", 0);
-		calculator_.addVariable("cumulativeWells", 0);
-		calculator_.addVariable("holeDepth", 0);
+	void Ai::updateCalculatorVariables() {
+		for (int i = 0; i < static_cast<int>(AiVariableNames.size()); ++i) {
+			calculator_.updateVariable(AiVariableNames[i], variables_[i]);
+		}
+	}
 
-		calculator_.addVariable("rows", 0);
-		calculator_.addVariable("columns", 0);
+	void Ai::initCalculator(bool allowException) {
+		for (const char* name : AiVariableNames) {
+			calculator_.addVariable(name, 0);
+		}
 
 		if (allowException) {
 			cache_ = calculator_.preCalculate(valueFunction_);
@@ -432,6 +862,60 @@ namespace tetris {
 			}
 		}
 		initAiParameters(calculator_, cache_);
+		initCompiledValueFunction();
+		initEarlyCutoff();
+	}
+
+	void Ai::initCompiledValueFunction() {
+		compiledValueFunction_ = ValueFunction::compile(valueFunction_);
+		if (!compiledValueFunction_) {
+			return;
+		}
+
+		// Use the calculator if the compiled value function does not give the same result,
+		// e.g. if the precedence differs.
+		constexpr std::array<AiVariables, 3> Samples{
+			AiVariables{3.f, 1.f, 20.f, 25.f, 5.f, 8.f, 12.f, 24.f, 10.f},
+			AiVariables{17.f, 0.f, 7.f, 13.f, 0.f, 1.f, 0.f, 20.f, 8.f},
+			AiVariables{0.5f, 4.f, 41.f, 2.f, 11.f, 121.f, 63.f, 99.f, 32.f}
+		};
+		for (const auto& sample : Samples) {
+			variables_ = sample;
+			updateCalculatorVariables();
+			const float expected = calculator_.excecute(cache_);
+			const float value = compiledValueFunction_->evaluate(sample);
+			if (!(std::abs(expected - value) <= 1e-4f * std::max(1.f, std::abs(expected)))) {
+				compiledValueFunction_.reset();
+				break;
+			}
+		}
+		variables_ = {};
+		updateCalculatorVariables();
+	}
+
+	void Ai::initEarlyCutoff() {
+		cutoffAfterBlock_ = false;
+		cutoffAfterHoles_ = false;
+		if (!compiledValueFunction_ || !compiledValueFunction_->isLinear()) {
+			return;
+		}
+
+		// Evaluated in the same term order, rounding keeps the value with zeroed features an upper bound.
+		auto hasNoPositiveWeight = [&](std::initializer_list<AiVariable> variables) {
+			return std::none_of(variables.begin(), variables.end(), [&](AiVariable variable) {
+				const auto& terms = compiledValueFunction_->getTerms();
+				return std::any_of(terms.begin(), terms.end(), [&](const ValueFunction::Term& term) {
+					return term.degree == 1 && term.variables[0] == static_cast<int>(variable) && term.coefficient > 0.f;
+				});
+			});
+		};
+		const bool holes = parameters_.rowHoles || parameters_.columnHoles || parameters_.holes;
+		const bool scan = parameters_.cumulativeWells || parameters_.holeDepth;
+
+		// A cutoff is only worth an extra evaluation of the value function when features are left.
+		cutoffAfterHoles_ = scan && hasNoPositiveWeight({AiVariable::CumulativeWells, AiVariable::HoleDepth});
+		cutoffAfterBlock_ = (holes || scan) && hasNoPositiveWeight({AiVariable::RowHoles, AiVariable::ColumnHoles,
+			AiVariable::Holes, AiVariable::CumulativeWells, AiVariable::HoleDepth});
 	}
 
 	void Ai::initAiParameters(const calc::Calculator& calculator, const calc::Cache& cache) {
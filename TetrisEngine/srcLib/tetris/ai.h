@@ -2,15 +2,20 @@
 #define TETRIS_AI_H
 
 #include "tetrisboard.h"
+#include "transpositiontable.h"
+#include "valuefunction.h"
 
 #include <calc/calculator.h>
 
 #include <string>
 #include <vector>
 #include <limits>
+#include <optional>
 
 namespace tetris {
 
+	class ThreadPool;
+
 	struct RowRoughness {
 		int holes;
 		int rowSum;
@@ -29,6 +34,7 @@ namespace tetris {
 
 	int calculateLandingHeight(const Block& block);
 	int calculateErodedPieces(const TetrisBoard& board);
+	int calculateErodedPieces(const TetrisBoard& board, const Block& block);
 	int calculateRowTransitions(const TetrisBoard& board);
 	int calculateColumnTransitions(const TetrisBoard& board);
 	int calculateNumberOfHoles(const TetrisBoard& board);
@@ -46,6 +52,22 @@ namespace tetris {
 		bool holeDepth;
 	};
 
+	// Same values as the feature functions above, features not calculated are zero.
+	struct AiFeatures {
+		int landingHeight = 0;
+		int erodedPieces = 0;
+		int rowHoles = 0;
+		int columnHoles = 0;
+		int holes = 0;
+		int cumulativeWells = 0;
+		int holeDepth = 0;
+	};
+
+	// Calculate the features of the board enabled in the parameters. Row transitions and holes use
+	// the board kernels, the other features are calculated in one pass over the rows.
+	// Landing height and eroded pieces depend on the block before impact and are not calculated.
+	AiFeatures calculateBoardFeatures(const TetrisBoard& board, const AiParameters& parameters);
+
 	class Ai {
 	public:
 		Ai();
@@ -60,26 +82,114 @@ namespace tetris {
 			return calculator_;
 		}
 
+		// The values of placements and of the next block searched on a board are cached
+		// between searches, size 0 turns off the cache. The cache is off by default.
+		void setTranspositionTableSize(int size);
+
+		const TranspositionTable& getTranspositionTable() const {
+			return transpositionTable_;
+		}
+
+		// Return true if the value function is evaluated as a polynomial, instead of by the calculator.
+		bool isValueFunctionCompiled() const {
+			return compiledValueFunction_.has_value();
+		}
+
+		// Stop evaluating a placement when the features calculated so far show that it can't beat
+		// the best placement, i.e. skip the expensive features. Used for a linear compiled value
+		// function when the remaining features have no positive weight. On by default, the search
+		// gives the same result either way.
+		void setEarlyCutoff(bool earlyCutoff) {
+			earlyCutoff_ = earlyCutoff;
+			threadAis_.clear();
+		}
+
+		bool isEarlyCutoff() const {
+			return earlyCutoff_;
+		}
+
 		struct State {
 			int left = 0;
 			int rotationLeft = 0;
 			float value = std::numeric_limits<float>::lowest();
 		};
 
+		// Number of boards kept between the levels of a beam search, if not provided.
+		static constexpr int DefaultBeamWidth = 8;
+
+		struct BeamSearch {
+			int depth = 3;
+			int width = DefaultBeamWidth;
+		};
+
+		// Depth 0, 1 and 2 search all placements of the current and the next block.
+		// A larger depth is the same as depth 2, use BeamSearch to search deeper.
 		State calculateBestState(const TetrisBoard& board, int depth);
+
+		// Search the placements of depth blocks, keeping the best width boards at each level.
+		// The current and the next block are known, the blocks after are expanded over all
+		// block types and valued by the expected value.
+		State calculateBestState(const TetrisBoard& board, const BeamSearch& beamSearch);
+
+		// Same result as without the thread pool, the placements are evaluated on the threads
+		// of the pool. Each thread uses a copy of the ai, with its own calculator.
+		State calculateBestState(const TetrisBoard& board, int depth, ThreadPool& threadPool);
+
+		State calculateBestState(const TetrisBoard& board, const BeamSearch& beamSearch, ThreadPool& threadPool);
+
+		// Move the current block to ground and return the value of placing it there.
+		// The board is left with the block at ground, before impact.
 		float moveBlockToGroundCalculateValue(const State& state, TetrisBoard& board);
 
 	private:
 		void initCalculator(bool allowException);
 		void initAiParameters(const calc::Calculator& calculator, const calc::Cache& cache);
+		void initCompiledValueFunction();
+		void initEarlyCutoff();
+
+		void updateCalculatorVariables();
+
+		// Placements not better than the bound may be skipped, the value of the state returned
+		// is exact when larger than the bound.
+		State calculateBestStateRecursive(TetrisBoard& board, int depth, float bound = std::numeric_limits<float>::lowest());
+
+		State calculateBestStateBeamSearch(const TetrisBoard& board, const BeamSearch& beamSearch, ThreadPool* threadPool);
+
+		// Return one copy of the ai for each thread, with the variables of the board.
+		std::vector<Ai>& updateThreadAis(const TetrisBoard& board, int threads);
+
+		void updateBoardVariables(const TetrisBoard& board);
+
+		// Value of the block placed at ground. The board is unchanged afterwards.
+		float evaluatePlacement(TetrisBoard& board, const Block& block);
+
+		// Same as above, but return nothing when the value is not larger than the bound and the
+		// evaluation was cut off early.
+		std::optional<float> evaluatePlacement(TetrisBoard& board, const Block& block, float bound);
+
+		// Same as evaluatePlacement, using the transposition table.
+		float calculatePlacementValue(TetrisBoard& board, const Block& block);
+
+		std::optional<float> calculatePlacementValue(TetrisBoard& board, const Block& block, float bound);
 
-		State calculateBestStateRecursive(const TetrisBoard& board, int depth);
+		// Best value of the current block on the board, at depth 1, using the transposition table.
+		// The value is exact when larger than the bound.
+		float calculateChildValue(TetrisBoard& board, float bound = std::numeric_limits<float>::lowest());
 		
 		std::string valueFunction_;
 
 		calc::Calculator calculator_;
 		calc::Cache cache_;
 		AiParameters parameters_{};
+		std::optional<ValueFunction> compiledValueFunction_;
+		AiVariables variables_{};
+		TranspositionTable transpositionTable_;
+		std::vector<Ai> threadAis_;
+		bool earlyCutoff_ = true;
+		// True if the value with the features not yet calculated set to zero is an upper bound,
+		// after the block features and after the hole features.
+		bool cutoffAfterBlock_ = false;
+		bool cutoffAfterHoles_ = false;
 	};
 
 	template <typename Board>
@@ -3,10 +3,12 @@
 
 #include <array>
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
 
 namespace tetris {
 
-	enum class BlockType {
+	enum class BlockType : char {
 		I = 'I',
 		J = 'J',
 		L = 'L',
@@ -18,39 +20,182 @@ namespace tetris {
 		Wall = 'W'
 	};
 
+	// One bit per column, bit 0 is the leftmost column. A set bit is a non empty square.
+	using RowMask = std::uint32_t;
+
 	struct Square {
 		int column;
 		int row;
 	};
 
-	inline bool operator==(const Square& left, const Square& right) {
+	constexpr bool operator==(const Square& left, const Square& right) {
 		return left.row == right.row && left.column == right.column;
 	}
 
-	inline bool operator!=(const Square& left, const Square& right) {
+	constexpr bool operator!=(const Square& left, const Square& right) {
 		return !(left == right);
 	}
 
+	// The squares of a block type in one rotation. All positions are relative to
+	// the start column and the lowest start row of the block.
+	struct BlockShape {
+		std::array<Square, 4> squares{};
+		int minColumn = 0;
+		int maxColumn = 0;
+		int minRow = 0;
+		int maxRow = 0;
+		// Row i holds the squares at row minRow + i, bit 0 is minColumn.
+		std::array<RowMask, 4> rowMasks{};
+		// Index i holds the lowest row of the squares in column minColumn + i.
+		std::array<int, 4> columnLowestRows{};
+	};
+
+	struct BlockShapes {
+		std::array<BlockShape, 4> rotations{};
+		int maxRotations = 0;
+		int rotationSquareIndex = 0;
+	};
+
+	constexpr int blockTypeIndex(BlockType blockType) {
+		switch (blockType) {
+			case BlockType::I: return 0;
+			case BlockType::J: return 1;
+			case BlockType::L: return 2;
+			case BlockType::O: return 3;
+			case BlockType::S: return 4;
+			case BlockType::T: return 5;
+			case BlockType::Z: return 6;
+			default: return 7;
+		}
+	}
+
+	namespace block {
+
+		constexpr BlockShape createBlockShape(const std::array<Square, 4>& squares) {
+			BlockShape shape{squares};
+			shape.minColumn = shape.maxColumn = squares[0].column;
+			shape.minRow = shape.maxRow = squares[0].row;
+			for (const auto& sq : squares) {
+				shape.minColumn = std::min(shape.minColumn, sq.column);
+				shape.maxColumn = std::max(shape.maxColumn, sq.column);
+				shape.minRow = std::min(shape.minRow, sq.row);
+				shape.maxRow = std::max(shape.maxRow, sq.row);
+			}
+			shape.columnLowestRows.fill(shape.maxRow);
+			for (const auto& sq : squares) {
+				shape.rowMasks[sq.row - shape.minRow] |= RowMask{1} << (sq.column - shape.minColumn);
+				auto& lowestRow = shape.columnLowestRows[sq.column - shape.minColumn];
+				lowestRow = std::min(lowestRow, sq.row);
+			}
+			return shape;
+		}
+
+		// Rotation is performed counter clockwise around the rotation square.
+		constexpr BlockShapes createBlockShapes(const std::array<Square, 4>& squares, int rotationSquareIndex, int maxRotations) {
+			BlockShapes shapes{};
+			shapes.maxRotations = maxRotations;
+			shapes.rotationSquareIndex = rotationSquareIndex;
+
+			const auto center = squares[rotationSquareIndex];
+			auto rotated = squares;
+			for (auto& shape : shapes.rotations) {
+				shape = createBlockShape(rotated);
+				for (auto& sq : rotated) {
+					sq = Square{center.column + center.row - sq.row, sq.column + center.row - center.column};
+				}
+			}
+			return shapes;
+		}
+
+		// Indexed by blockTypeIndex(), the squares are defined for the default rotation.
+		inline constexpr std::array<BlockShapes, 8> BlockShapesTable{
+			createBlockShapes({Square{0, 3}, Square{0, 2}, Square{0, 1}, Square{0, 0}}, 2, 1), // I
+			createBlockShapes({Square{1, 2}, Square{1, 1}, Square{1, 0}, Square{0, 0}}, 1, 4), // J
+			createBlockShapes({Square{0, 2}, Square{0, 1}, Square{0, 0}, Square{1, 0}}, 1, 4), // L
+			createBlockShapes({Square{0, 1}, Square{1, 1}, Square{0, 0}, Square{1, 0}}, 0, 0), // O
+			createBlockShapes({Square{1, 1}, Square{0, 1}, Square{0, 0}, Square{-1, 0}}, 2, 1), // S
+			createBlockShapes({Square{0, 1}, Square{1, 0}, Square{0, 0}, Square{-1, 0}}, 2, 4), // T
+			createBlockShapes({Square{-1, 1}, Square{0, 1}, Square{0, 0}, Square{1, 0}}, 2, 1), // Z
+			createBlockShapes({Square{0, 0}, Square{0, 0}, Square{0, 0}, Square{0, 0}}, 0, 0) // Empty
+		};
+
+	}
+
+	constexpr const BlockShapes& getBlockShapes(BlockType blockType) {
+		return block::BlockShapesTable[blockTypeIndex(blockType)];
+	}
+
+	// A block is only its type, rotation and position. The squares are looked up in
+	// a precomputed table.
 	class Block {
 	public:
-		using const_iterator = std::array<Square, 4>::const_iterator;
+		class const_iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Square;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = Square;
+
+			const_iterator() = default;
+
+			const_iterator(const Square* offset, int column, int row)
+				: offset_{offset}
+				, column_{column}
+				, row_{row} {
+			}
+
+			Square operator*() const {
+				return Square{offset_->column + column_, offset_->row + row_};
+			}
+
+			const_iterator& operator++() {
+				++offset_;
+				return *this;
+			}
+
+			const_iterator operator++(int) {
+				auto tmp = *this;
+				++offset_;
+				return tmp;
+			}
+
+			bool operator==(const const_iterator& other) const {
+				return offset_ == other.offset_;
+			}
+
+		private:
+			const Square* offset_ = nullptr;
+			int column_ = 0;
+			int row_ = 0;
+		};
 
 		Block() = default;
 		Block(BlockType blockType, int startColumn, int lowestStartRow);
 		Block(BlockType blockType, int startColumn, int lowestStartRow, int rotations);
 
-		void moveLeft();
-		void moveRight();
-		void moveDown();
+		void moveLeft() {
+			--startColumn_;
+		}
+
+		void moveRight() {
+			++startColumn_;
+		}
+
+		void moveDown() {
+			--lowestStartRow_;
+		}
+
 		void rotateLeft();
 		void rotateRight();
 
 		int getSize() const {
-			return static_cast<int>(squares_.size());
+			return 4;
 		}
 
 		Square getRotationSquare() const {
-			return squares_[rotationSquareIndex_];
+			const auto& shapes = getBlockShapes(blockType_);
+			return toSquare(shapes.rotations[currentRotation_].squares[shapes.rotationSquareIndex]);
 		}
 
 		BlockType getBlockType() const {
@@ -59,7 +204,7 @@ namespace tetris {
 
 		[[deprecated("Better to not assume layout, use iterator")]]
 		Square operator[](int index) const {
-			return squares_[index];
+			return toSquare(getShape().squares[index]);
 		}
 
 		// Return the lowest row when the block is in default rotation.
@@ -69,19 +214,19 @@ namespace tetris {
 		}
 
 		int getLowestRow() const {
-			return std::min({squares_[0].row, squares_[1].row, squares_[2].row, squares_[3].row});;
+			return lowestStartRow_ + getShape().minRow;
 		}
 
 		const_iterator begin() const {
-			return squares_.begin();
+			return const_iterator{getShape().squares.data(), startColumn_, lowestStartRow_};
 		}
 
 		const_iterator end() const {
-			return squares_.end();
+			return const_iterator{getShape().squares.data() + 4, startColumn_, lowestStartRow_};
 		}
 
 		int getNumberOfRotations() const {
-			return maxRotations_;
+			return getBlockShapes(blockType_).maxRotations;
 		}
 
 		int getCurrentRotation() const {
@@ -92,16 +237,20 @@ namespace tetris {
 			return startColumn_;
 		}
 
+		// Return the squares for the current rotation, relative to the start column and lowest start row.
+		const BlockShape& getShape() const {
+			return getBlockShapes(blockType_).rotations[currentRotation_];
+		}
+
 	private:
-		void rotate(int rotate);
-
-		std::array<Square, 4> squares_{};
-		int rotationSquareIndex_ = 0;
-		int maxRotations_ = 4;
-		int currentRotation_ = 0;
-		int lowestStartRow_ = 0;
-		int startColumn_ = 0;
+		Square toSquare(Square offset) const {
+			return Square{offset.column + startColumn_, offset.row + lowestStartRow_};
+		}
+
 		BlockType blockType_ = BlockType::Empty;
+		std::int8_t currentRotation_ = 0;
+		std::int16_t startColumn_ = 0;
+		std::int16_t lowestStartRow_ = 0;
 	};
 
 }
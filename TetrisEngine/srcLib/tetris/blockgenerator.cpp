@@ -0,0 +1,45 @@
+#include "blockgenerator.h"
+
+#include <random>
+#include <utility>
+
+namespace tetris {
+
+	namespace {
+
+		constexpr std::array<BlockType, 7> BlockTypes{
+			BlockType::I, BlockType::J, BlockType::L,
+			BlockType::O, BlockType::S, BlockType::T, BlockType::Z
+		};
+
+	}
+
+	BlockGenerator::BlockGenerator(std::uint64_t seed, BlockGeneratorMode mode)
+		: random_{seed}
+		, seed_{seed}
+		, mode_{mode}
+		, bag_{BlockTypes}
+		, bagIndex_{static_cast<int>(BlockTypes.size())} {
+	}
+
+	std::uint64_t BlockGenerator::generateSeed() {
+		std::random_device device;
+		return (std::uint64_t{device()} << 32) | device();
+	}
+
+	BlockType BlockGenerator::generateBlockType() {
+		if (mode_ == BlockGeneratorMode::Uniform) {
+			return BlockTypes[random_.generateInt(0, static_cast<int>(BlockTypes.size()) - 1)];
+		}
+
+		if (bagIndex_ == static_cast<int>(bag_.size())) {
+			// Fisher-Yates shuffle of a new bag.
+			for (int i = static_cast<int>(bag_.size()) - 1; i > 0; --i) {
+				std::swap(bag_[i], bag_[random_.generateInt(0, i)]);
+			}
+			bagIndex_ = 0;
+		}
+		return bag_[bagIndex_++];
+	}
+
+}
@@ -0,0 +1,104 @@
+#ifndef TETRIS_BLOCKGENERATOR_H
+#define TETRIS_BLOCKGENERATOR_H
+
+#include "block.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace tetris {
+
+	// Permuted congruential generator (PCG32, XSH RR). Small state and fast, usable with the
+	// standard distributions.
+	class Pcg32 {
+	public:
+		using result_type = std::uint32_t;
+
+		explicit Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0x14057b7ef767814full)
+			: increment_{(stream << 1) | 1} {
+
+			(*this)();
+			state_ += seed;
+			(*this)();
+		}
+
+		static constexpr result_type min() {
+			return std::numeric_limits<result_type>::min();
+		}
+
+		static constexpr result_type max() {
+			return std::numeric_limits<result_type>::max();
+		}
+
+		result_type operator()() {
+			const std::uint64_t old = state_;
+			state_ = old * 6364136223846793005ull + increment_;
+			const auto xorShifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+			const auto rotation = static_cast<std::uint32_t>(old >> 59);
+			return (xorShifted >> rotation) | (xorShifted << ((~rotation + 1) & 31));
+		}
+
+		// Return a uniform integer in [min, max], without modulo bias.
+		int generateInt(int min, int max) {
+			const auto range = static_cast<std::uint32_t>(max - min) + 1;
+			// Lemire's multiply and shift, retry only for the biased low part.
+			std::uint64_t product = std::uint64_t{(*this)()} * range;
+			if (static_cast<std::uint32_t>(product) < range) {
+				const std::uint32_t threshold = (~range + 1) % range;
+				while (static_cast<std::uint32_t>(product) < threshold) {
+					product = std::uint64_t{(*this)()} * range;
+				}
+			}
+			return min + static_cast<int>(product >> 32);
+		}
+
+	private:
+		std::uint64_t state_ = 0;
+		std::uint64_t increment_;
+	};
+
+	enum class BlockGeneratorMode {
+		Uniform, // Each block type with the same probability.
+		Bag7     // All seven block types in random order, then the next seven etc.
+	};
+
+	// Deterministic sequence of block types, the same seed and mode give the same sequence.
+	class BlockGenerator {
+	public:
+		explicit BlockGenerator(std::uint64_t seed, BlockGeneratorMode mode = BlockGeneratorMode::Uniform);
+
+		// Return a seed from the operating system, for games which are not to be repeated.
+		static std::uint64_t generateSeed();
+
+		BlockType generateBlockType();
+
+		// Random numbers from the same sequence, e.g. for holes in external rows.
+		int generateInt(int min, int max) {
+			return random_.generateInt(min, max);
+		}
+
+		// Return a seed from the same sequence, e.g. for the generator of each game in a seeded room.
+		std::uint64_t generateChildSeed() {
+			return (std::uint64_t{random_()} << 32) | random_();
+		}
+
+		std::uint64_t getSeed() const {
+			return seed_;
+		}
+
+		BlockGeneratorMode getMode() const {
+			return mode_;
+		}
+
+	private:
+		Pcg32 random_;
+		std::uint64_t seed_;
+		BlockGeneratorMode mode_;
+		std::array<BlockType, 7> bag_;
+		int bagIndex_;
+	};
+
+}
+
+#endif
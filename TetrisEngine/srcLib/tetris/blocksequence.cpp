@@ -0,0 +1,140 @@
+#include "blocksequence.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tetris {
+
+	namespace {
+
+		constexpr std::array<BlockType, 7> BlockTypes{
+			BlockType::I, BlockType::J, BlockType::L,
+			BlockType::O, BlockType::S, BlockType::T, BlockType::Z
+		};
+
+#ifdef _WIN32
+		std::span<const std::uint8_t> mapFile(const std::string& path) {
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) {
+				throw std::runtime_error{"Failed to open " + path};
+			}
+			LARGE_INTEGER fileSize{};
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+				CloseHandle(file);
+				throw std::runtime_error{"Failed to map empty file " + path};
+			}
+			HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (fileMapping == nullptr) {
+				throw std::runtime_error{"Failed to map " + path};
+			}
+			// The view keeps the mapping alive after the handle is closed.
+			void* data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(fileMapping);
+			if (data == nullptr) {
+				throw std::runtime_error{"Failed to map " + path};
+			}
+			return {static_cast<const std::uint8_t*>(data), static_cast<std::size_t>(fileSize.QuadPart)};
+		}
+
+		void unmapFile(std::span<const std::uint8_t> mapping) {
+			UnmapViewOfFile(mapping.data());
+		}
+#else
+		std::span<const std::uint8_t> mapFile(const std::string& path) {
+			int file = open(path.c_str(), O_RDONLY);
+			if (file == -1) {
+				throw std::runtime_error{"Failed to open " + path};
+			}
+			struct stat fileStatus{};
+			if (fstat(file, &fileStatus) == -1 || fileStatus.st_size == 0) {
+				close(file);
+				throw std::runtime_error{"Failed to map empty file " + path};
+			}
+			const auto size = static_cast<std::size_t>(fileStatus.st_size);
+			// The mapping stays valid after the file is closed.
+			void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+			close(file);
+			if (data == MAP_FAILED) {
+				throw std::runtime_error{"Failed to map " + path};
+			}
+			return {static_cast<const std::uint8_t*>(data), size};
+		}
+
+		void unmapFile(std::span<const std::uint8_t> mapping) {
+			munmap(const_cast<std::uint8_t*>(mapping.data()), mapping.size());
+		}
+#endif
+
+	}
+
+	BlockSequence::BlockSequence(const std::string& path) {
+		const auto mapping = mapFile(path);
+		mapping_ = mapping.data();
+		mappingSize_ = mapping.size();
+
+		// Only the header is read here, the pages of the block types are read when used.
+		const auto header = std::string_view{reinterpret_cast<const char*>(mapping_), std::min(mappingSize_, Header.size())};
+		if (header != Header || mappingSize_ == Header.size()) {
+			unmapFile(mapping);
+			throw std::runtime_error{"Not a valid block sequence file " + path};
+		}
+		size_ = mappingSize_ - Header.size();
+	}
+
+	BlockSequence::~BlockSequence() {
+		unmapFile({mapping_, mappingSize_});
+	}
+
+	bool BlockSequence::hasHeader(const std::string& path) {
+		std::ifstream file{path, std::ios::binary};
+		std::string header(Header.size(), '\0');
+		return file.read(header.data(), header.size()) && header == Header;
+	}
+
+	void BlockSequence::write(const std::string& path, std::span<const BlockType> blockTypes) {
+		std::vector<char> data(Header.begin(), Header.end());
+		data.reserve(Header.size() + blockTypes.size());
+		for (auto blockType : blockTypes) {
+			const int index = toBlockTypeIndex(blockType);
+			if (index < 0) {
+				throw std::runtime_error{"Block sequence can only hold the block types I, J, L, O, S, T and Z"};
+			}
+			data.push_back(static_cast<char>(index));
+		}
+
+		std::ofstream file{path, std::ios::binary};
+		if (!file.write(data.data(), data.size())) {
+			throw std::runtime_error{"Failed to write " + path};
+		}
+	}
+
+	BlockType BlockSequence::getBlockType(std::size_t index) const {
+		return BlockTypes[mapping_[Header.size() + index % size_] % BlockTypes.size()];
+	}
+
+	BlockType toBlockType(int index) {
+		if (index < 0 || index >= static_cast<int>(BlockTypes.size())) {
+			return BlockType::Empty;
+		}
+		return BlockTypes[index];
+	}
+
+	int toBlockTypeIndex(BlockType blockType) {
+		const auto it = std::find(BlockTypes.begin(), BlockTypes.end(), blockType);
+		return it == BlockTypes.end() ? -1 : static_cast<int>(it - BlockTypes.begin());
+	}
+
+}
@@ -0,0 +1,60 @@
+#ifndef TETRIS_BLOCKSEQUENCE_H
+#define TETRIS_BLOCKSEQUENCE_H
+
+#include "block.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace tetris {
+
+	// Block types read from a memory mapped file. The mapping is read only, i.e. one sequence
+	// can be shared by many threads without copying.
+	//
+	// The file starts with the header "MWBLOCK1", followed by one byte for each block type,
+	// 0 to 6 for I, J, L, O, S, T and Z. A byte above 6 is read modulo 7.
+	class BlockSequence {
+	public:
+		static constexpr std::string_view Header = "MWBLOCK1";
+
+		// Throws std::runtime_error if the file can't be mapped, has the wrong header or
+		// holds no block types. Only the header is read.
+		explicit BlockSequence(const std::string& path);
+
+		~BlockSequence();
+
+		BlockSequence(const BlockSequence&) = delete;
+		BlockSequence& operator=(const BlockSequence&) = delete;
+
+		// Return true if the file starts with the header.
+		static bool hasHeader(const std::string& path);
+
+		// Throws std::runtime_error if the file can't be written.
+		static void write(const std::string& path, std::span<const BlockType> blockTypes);
+
+		std::size_t getSize() const {
+			return size_;
+		}
+
+		// Start from the beginning again after the last block type.
+		BlockType getBlockType(std::size_t index) const;
+
+	private:
+		const std::uint8_t* mapping_ = nullptr;
+		std::size_t mappingSize_ = 0;
+		std::size_t size_ = 0;
+	};
+
+	// Return the block type with index 0 to 6, in the order I, J, L, O, S, T and Z.
+	// Any other index returns BlockType::Empty.
+	BlockType toBlockType(int index);
+
+	// Return the index 0 to 6 of block type I, J, L, O, S, T or Z, -1 for other types.
+	int toBlockTypeIndex(BlockType blockType);
+
+}
+
+#endif
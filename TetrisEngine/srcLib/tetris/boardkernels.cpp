@@ -0,0 +1,219 @@
+#include "boardkernels.h"
+
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TETRIS_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(TETRIS_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TETRIS_TARGET_SSE2 __attribute__((target("sse2")))
+#define TETRIS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TETRIS_TARGET_SSE2
+#define TETRIS_TARGET_AVX2
+#endif
+
+namespace tetris {
+
+	namespace {
+
+		int scalarRowTransitions(std::span<const RowMask> rows, int columns) {
+			const RowMask rightWall = RowMask{1} << (columns - 1);
+			int transitions = 0;
+			for (RowMask row : rows) {
+				transitions += std::popcount(row & ~((row << 1) | RowMask{1}));
+				transitions += (row & rightWall) == 0 ? 1 : 0;
+			}
+			return transitions;
+		}
+
+		int scalarHoles(std::span<const RowMask> rows) {
+			int holes = 0;
+			for (std::size_t y = 1; y < rows.size(); ++y) {
+				holes += std::popcount(~rows[y - 1] & rows[y]);
+			}
+			return holes;
+		}
+
+#ifdef TETRIS_KERNELS_X86
+
+		// Number of set bits in each byte, using SWAR.
+		TETRIS_TARGET_SSE2 __m128i popcountBytes(__m128i x) {
+			const __m128i m1 = _mm_set1_epi8(0x55);
+			const __m128i m2 = _mm_set1_epi8(0x33);
+			const __m128i m4 = _mm_set1_epi8(0x0f);
+			x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), m1));
+			x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi16(x, 2), m2));
+			return _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), m4);
+		}
+
+		TETRIS_TARGET_SSE2 int sumBytes(__m128i sum) {
+			sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+			return _mm_cvtsi128_si32(sum);
+		}
+
+		TETRIS_TARGET_SSE2 int sse2RowTransitions(std::span<const RowMask> rows, int columns) {
+			const __m128i one = _mm_set1_epi32(1);
+			const __m128i allOnes = _mm_set1_epi32(-1);
+			const __m128i shift = _mm_cvtsi32_si128(columns - 1);
+			__m128i sum = _mm_setzero_si128();
+
+			std::size_t y = 0;
+			for (; y + 4 <= rows.size(); y += 4) {
+				const __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.data() + y));
+				const __m128i transitions = _mm_andnot_si128(_mm_or_si128(_mm_slli_epi32(row, 1), one), row);
+				const __m128i lastEmpty = _mm_and_si128(_mm_srl_epi32(_mm_xor_si128(row, allOnes), shift), one);
+				const __m128i counts = _mm_add_epi8(popcountBytes(transitions), lastEmpty);
+				sum = _mm_add_epi64(sum, _mm_sad_epu8(counts, _mm_setzero_si128()));
+			}
+			return sumBytes(sum) + scalarRowTransitions(rows.subspan(y), columns);
+		}
+
+		TETRIS_TARGET_SSE2 int sse2Holes(std::span<const RowMask> rows) {
+			__m128i sum = _mm_setzero_si128();
+
+			std::size_t y = 1;
+			for (; y + 4 <= rows.size(); y += 4) {
+				const __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.data() + y));
+				const __m128i below = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.data() + y - 1));
+				const __m128i holes = _mm_andnot_si128(below, row);
+				sum = _mm_add_epi64(sum, _mm_sad_epu8(popcountBytes(holes), _mm_setzero_si128()));
+			}
+			int holes = sumBytes(sum);
+			for (; y < rows.size(); ++y) {
+				holes += std::popcount(~rows[y - 1] & rows[y]);
+			}
+			return holes;
+		}
+
+		// Number of set bits in each byte, using a nibble lookup table.
+		TETRIS_TARGET_AVX2 __m256i popcountBytes(__m256i x) {
+			const __m256i lookup = _mm256_setr_epi8(
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+			const __m256i low = _mm256_set1_epi8(0x0f);
+			const __m256i lowCount = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low));
+			const __m256i highCount = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), low));
+			return _mm256_add_epi8(lowCount, highCount);
+		}
+
+		TETRIS_TARGET_AVX2 int sumBytes(__m256i sum) {
+			const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+			return _mm_cvtsi128_si32(_mm_add_epi64(half, _mm_unpackhi_epi64(half, half)));
+		}
+
+		TETRIS_TARGET_AVX2 int avx2RowTransitions(std::span<const RowMask> rows, int columns) {
+			const __m256i one = _mm256_set1_epi32(1);
+			const __m256i allOnes = _mm256_set1_epi32(-1);
+			const __m128i shift = _mm_cvtsi32_si128(columns - 1);
+			__m256i sum = _mm256_setzero_si256();
+
+			std::size_t y = 0;
+			for (; y + 8 <= rows.size(); y += 8) {
+				const __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows.data() + y));
+				const __m256i transitions = _mm256_andnot_si256(_mm256_or_si256(_mm256_slli_epi32(row, 1), one), row);
+				const __m256i lastEmpty = _mm256_and_si256(_mm256_srl_epi32(_mm256_xor_si256(row, allOnes), shift), one);
+				const __m256i counts = _mm256_add_epi8(popcountBytes(transitions), lastEmpty);
+				sum = _mm256_add_epi64(sum, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+			}
+			return sumBytes(sum) + scalarRowTransitions(rows.subspan(y), columns);
+		}
+
+		TETRIS_TARGET_AVX2 int avx2Holes(std::span<const RowMask> rows) {
+			__m256i sum = _mm256_setzero_si256();
+
+			std::size_t y = 1;
+			for (; y + 8 <= rows.size(); y += 8) {
+				const __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows.data() + y));
+				const __m256i below = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows.data() + y - 1));
+				const __m256i holes = _mm256_andnot_si256(below, row);
+				sum = _mm256_add_epi64(sum, _mm256_sad_epu8(popcountBytes(holes), _mm256_setzero_si256()));
+			}
+			int holes = sumBytes(sum);
+			for (; y < rows.size(); ++y) {
+				holes += std::popcount(~rows[y - 1] & rows[y]);
+			}
+			return holes;
+		}
+
+		bool isAvx2Supported() {
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return false;
+			}
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			// The operating system must save the ymm registers.
+			if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+
+#endif
+
+		constexpr BoardKernels ScalarKernels{KernelType::Scalar, scalarRowTransitions, scalarHoles};
+
+#ifdef TETRIS_KERNELS_X86
+		constexpr BoardKernels Sse2Kernels{KernelType::Sse2, sse2RowTransitions, sse2Holes};
+		constexpr BoardKernels Avx2Kernels{KernelType::Avx2, avx2RowTransitions, avx2Holes};
+#endif
+
+	}
+
+	bool isKernelTypeSupported(KernelType type) {
+		switch (type) {
+			case KernelType::Scalar:
+				return true;
+#ifdef TETRIS_KERNELS_X86
+			case KernelType::Sse2:
+				// Part of all x86-64 cpus, and all x86 cpus the game runs on.
+				return true;
+			case KernelType::Avx2: {
+				static const bool supported = isAvx2Supported();
+				return supported;
+			}
+#endif
+			default:
+				return false;
+		}
+	}
+
+	const BoardKernels& getBoardKernels(KernelType type) {
+		switch (type) {
+#ifdef TETRIS_KERNELS_X86
+			case KernelType::Sse2:
+				return Sse2Kernels;
+			case KernelType::Avx2:
+				return Avx2Kernels;
+#endif
+			default:
+				return ScalarKernels;
+		}
+	}
+
+	const BoardKernels& getBoardKernels() {
+		static const BoardKernels& kernels = [] () -> const BoardKernels& {
+			for (auto type : {KernelType::Avx2, KernelType::Sse2}) {
+				if (isKernelTypeSupported(type)) {
+					return getBoardKernels(type);
+				}
+			}
+			return ScalarKernels;
+		}();
+		return kernels;
+	}
+
+}
@@ -0,0 +1,40 @@
+#ifndef TETRIS_BOARDKERNELS_H
+#define TETRIS_BOARDKERNELS_H
+
+#include "block.h"
+
+#include <span>
+
+namespace tetris {
+
+	enum class KernelType {
+		Scalar,
+		Sse2,
+		Avx2
+	};
+
+	// Feature kernels over row masks, index 0 is the lowest row and the rows above
+	// the last one are empty. Same result for all kernel types.
+	struct BoardKernels {
+		KernelType type;
+
+		// Filled squares with an empty square to the left, plus rows with an empty last column.
+		// The left wall counts as filled.
+		int (*rowTransitions)(std::span<const RowMask> rows, int columns);
+
+		// Empty squares with a filled square directly above. Also the column transitions,
+		// minus one for each column.
+		int (*holes)(std::span<const RowMask> rows);
+	};
+
+	bool isKernelTypeSupported(KernelType type);
+
+	// Return the kernels of the type provided, must be supported by the cpu.
+	const BoardKernels& getBoardKernels(KernelType type);
+
+	// Return the fastest kernels supported by the cpu, selected once at runtime.
+	const BoardKernels& getBoardKernels();
+
+}
+
+#endif
@@ -1,24 +1,30 @@
 #include "helper.h"
-#include "random.h"
 
 namespace tetris {
 
-	BlockType randomBlockType() {
-		Random random;
-		constexpr std::array BlockTypes{
-			BlockType::I, BlockType::J, BlockType::L,
-			BlockType::O ,BlockType::S, BlockType::T, BlockType::Z};
+	namespace {
+
+		BlockGenerator& getThreadBlockGenerator() {
+			thread_local BlockGenerator blockGenerator{BlockGenerator::generateSeed()};
+			return blockGenerator;
+		}
+
+	}
 
-		return BlockTypes[random.generateInt(0, static_cast<int>(BlockTypes.size()) - 1)];
+	BlockType randomBlockType() {
+		return getThreadBlockGenerator().generateBlockType();
 	}
 
 	std::vector<BlockType> generateRow(const TetrisBoard& board, double squaresPerLength) {
+		return generateRow(board, squaresPerLength, getThreadBlockGenerator());
+	}
+
+	std::vector<BlockType> generateRow(const TetrisBoard& board, double squaresPerLength, BlockGenerator& blockGenerator) {
 		const auto size = board.getColumns();
 
-		Random random;
 		std::vector<bool> row(size);
 		for (int i = 0; i < size * squaresPerLength; ++i) {
-			int index = random.generateInt(0, size - 1);
+			int index = blockGenerator.generateInt(0, size - 1);
 			int nbr = 0;
 			while (nbr < size) {
 				if (!row[(index + nbr) % size]) {
@@ -36,7 +42,7 @@ namespace tetris {
 
 			// Fill square?
 			if (row[i]) {
-				blockType = randomBlockType();
+				blockType = blockGenerator.generateBlockType();
 			}
 			rows.push_back(blockType);
 		}
@@ -44,14 +50,17 @@ namespace tetris {
 	}
 
 	std::vector<BlockType> generateRow(int width, int holes) {
+		return generateRow(width, holes, getThreadBlockGenerator());
+	}
+
+	std::vector<BlockType> generateRow(int width, int holes, BlockGenerator& blockGenerator) {
 		std::vector<BlockType> row(width);
 		for (auto& type : row) {
-			type = randomBlockType();;
+			type = blockGenerator.generateBlockType();
 		}
 
-		static Random random;
 		for (int i = 0; i < holes; ++i) {
-			int index = random.generateInt(0, width - 1);
+			int index = blockGenerator.generateInt(0, width - 1);
 			if (row[index] == BlockType::Empty) {
 				--i;
 			} else {
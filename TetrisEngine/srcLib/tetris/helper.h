@@ -3,17 +3,23 @@
 
 #include "tetrisboard.h"
 #include "block.h"
+#include "blockgenerator.h"
 
 #include <vector>
 
 namespace tetris {
 
+	// Return a uniform random block type, from a generator seeded once per thread.
 	BlockType randomBlockType();
 
 	std::vector<BlockType> generateRow(const TetrisBoard& board, double squaresPerLength);
 
+	std::vector<BlockType> generateRow(const TetrisBoard& board, double squaresPerLength, BlockGenerator& blockGenerator);
+
 	std::vector<BlockType> generateRow(int width, int holes);
 
+	std::vector<BlockType> generateRow(int width, int holes, BlockGenerator& blockGenerator);
+
 }
 
 #endif
@@ -1,47 +1,132 @@
 #include "tetrisboard.h"
 #include "block.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
 
 namespace tetris {
 
+	namespace {
+
+		// The row masks, column heights and placement undo hold at most MaxColumns columns.
+		int checkColumns(int columns) {
+			if (columns <= 0 || columns > TetrisBoard::MaxColumns) {
+				throw std::invalid_argument{"Board columns must be between 1 and " + std::to_string(TetrisBoard::MaxColumns) + ", not " + std::to_string(columns)};
+			}
+			return columns;
+		}
+
+		RowMask calculateFilledRowMask(int columns) {
+			return static_cast<RowMask>((std::uint64_t{1} << checkColumns(columns)) - 1);
+		}
+
+	}
+
 	TetrisBoard::TetrisBoard(int columns, int rows, BlockType current, BlockType next)
-		: gameboard_(rows * columns, BlockType::Empty)
+		: squares_(rows * checkColumns(columns), BlockType::Empty)
+		, rowMasks_(rows, 0)
+		, filledRowMask_{calculateFilledRowMask(columns)}
 		, next_{next}
 		, columns_{columns}
 		, rows_{rows} {
 		
+		initRowSlots();
 		current_ = createBlock(current);
 	}
 
+	void TetrisBoard::initRowSlots() {
+		rowSlots_.resize(squares_.size() / columns_);
+		std::iota(rowSlots_.begin(), rowSlots_.end(), 0);
+	}
+
+	void TetrisBoard::initRowMasks() {
+		const int storedRows = getStoredRows();
+		rowMasks_.assign(storedRows, 0);
+		for (int row = 0; row < storedRows; ++row) {
+			for (int column = 0; column < columns_; ++column) {
+				if (board(column, row) != BlockType::Empty) {
+					rowMasks_[row] |= RowMask{1} << column;
+				}
+			}
+		}
+	}
+
+	void TetrisBoard::initColumnHeights() {
+		columnHeights_.fill(0);
+		updateColumnHeights(filledRowMask_, static_cast<int>(rowMasks_.size()));
+		updateHighestUsedRow();
+	}
+
+	void TetrisBoard::updateColumnHeights(RowMask columns, int row) {
+		for (auto sq = columns; sq != 0; sq &= sq - 1) {
+			columnHeights_[std::countr_zero(sq)] = 0;
+		}
+		for (--row; row >= 0 && columns != 0; --row) {
+			RowMask highest = rowMasks_[row] & columns;
+			columns &= ~highest;
+			for (; highest != 0; highest &= highest - 1) {
+				columnHeights_[std::countr_zero(highest)] = row + 1;
+			}
+		}
+	}
+
+	void TetrisBoard::updateHighestUsedRow() {
+		const auto heights = std::span{columnHeights_}.first(columns_);
+		highestUsedRow_ = std::max(*std::max_element(heights.begin(), heights.end()) - 1, 0);
+	}
+
+	void TetrisBoard::initSquaresHash() {
+		squaresHash_ = 0;
+		const int rows = std::min(highestUsedRow_ + 1, static_cast<int>(rowMasks_.size()));
+		for (int row = 0; row < rows; ++row) {
+			for (RowMask columns = rowMasks_[row]; columns != 0; columns &= columns - 1) {
+				squaresHash_ ^= zobrist::squareKey(std::countr_zero(columns), row);
+			}
+		}
+	}
+
+	std::uint64_t TetrisBoard::getHash() const {
+		return squaresHash_ ^ zobrist::blockTypeKey(current_.getBlockType(), 0) ^ zobrist::blockTypeKey(next_, 1);
+	}
+
+	// Only called by the constructor, when row i is in slot i.
 	void TetrisBoard::removeEmptyRowsOutsideBoard() {
-		const auto FilledRows = static_cast<int>(gameboard_.size()) / columns_;
+		const auto FilledRows = getStoredRows();
 		const auto Nbr = FilledRows - rows_;
 		for (int i = 1; i <= Nbr; ++i) {
 			const auto Row = FilledRows - i;
 			if (isRowEmpty(Row)) {
-				for (int column = 0; column < columns_; ++column) {
-					gameboard_.pop_back();
-				}
+				squares_.resize(squares_.size() - columns_);
+				rowSlots_.pop_back();
+				rowMasks_.pop_back();
 			}
 		}
 	}
 
 	void TetrisBoard::removeUnfilledRows() {
-		const auto Nbr = static_cast<int>(gameboard_.size()) % columns_;
-		for (int i = 0; i < Nbr; ++i) {
-			gameboard_.pop_back();
-		}
+		squares_.resize(squares_.size() - squares_.size() % columns_);
 	}
 
 	TetrisBoard::TetrisBoard(const std::vector<BlockType>& board, int columns, int rows, const Block& current, BlockType next)
-		: gameboard_(rows * columns, BlockType::Empty)
+		: squares_(board)
+		, filledRowMask_{calculateFilledRowMask(columns)}
 		, next_{next}
 		, current_{current}
 		, columns_{columns}
 		, rows_{rows} {
 
-		gameboard_.insert(gameboard_.begin(), board.begin(), board.end());
+		squares_.insert(squares_.end(), rows * columns, BlockType::Empty);
 		removeUnfilledRows();
+		initRowSlots();
+		initRowMasks();
 		removeEmptyRowsOutsideBoard();
+		initColumnHeights();
+		initSquaresHash();
 
 		if (collision(current)) {
 			isGameOver_ = true;
@@ -61,7 +146,13 @@ namespace tetris {
 		rows_ = rows;
 		columns_ = columns;
 		current_ = createBlock(current);
-		gameboard_.assign(rows_ * columns_, BlockType::Empty);
+		squares_.assign(rows_ * columns_, BlockType::Empty);
+		initRowSlots();
+		rowMasks_.assign(rows_, 0);
+		columnHeights_.fill(0);
+		highestUsedRow_ = 0;
+		squaresHash_ = 0;
+		filledRowMask_ = calculateFilledRowMask(columns_);
 		isGameOver_ = false;
 	}
 
@@ -78,76 +169,188 @@ namespace tetris {
 		return current;
 	}
 
-	const std::vector<BlockType>& TetrisBoard::getBoardVector() const {
-		return gameboard_;
+	Block TetrisBoard::getBlockDown(const Block& current, const ColumnHeights& heights) const {
+		const auto& shape = current.getShape();
+		const int column = current.getStartColumn() + shape.minColumn;
+		int lowestStartRow = std::numeric_limits<int>::lowest();
+		for (int i = 0; i <= shape.maxColumn - shape.minColumn; ++i) {
+			const int height = heights[column + i];
+			const int lowestRow = shape.columnLowestRows[i];
+			if (height > current.getLowestStartRow() + lowestRow) {
+				// Non empty square above the block, i.e. the block does not fall straight down to the height.
+				return getBlockDown(current);
+			}
+			lowestStartRow = std::max(lowestStartRow, height - lowestRow);
+		}
+		return Block{current.getBlockType(), current.getStartColumn(), lowestStartRow, current.getCurrentRotation()};
 	}
 
-	void TetrisBoard::addBlockToBoard(const Block& block) {
-		for (const auto& sq : block) {
-			board(sq.column, sq.row) = block.getBlockType();
+	std::vector<BlockType> TetrisBoard::getBoardVector() const {
+		std::vector<BlockType> boardVector;
+		boardVector.reserve(squares_.size());
+		for (int slot : rowSlots_) {
+			const auto row = squares_.begin() + slot * columns_;
+			boardVector.insert(boardVector.end(), row, row + columns_);
 		}
+		return boardVector;
 	}
 
-	Block TetrisBoard::createBlock(BlockType blockType) const {
-		return Block{blockType, columns_ / 2 - 1, rows_ - 4}; // 4 rows are the starting area.
+	void TetrisBoard::releaseRowSlot(int slot) {
+		const int lastSlot = static_cast<int>(squares_.size()) / columns_ - 1;
+		if (slot != lastSlot) {
+			std::copy_n(squares_.begin() + lastSlot * columns_, columns_, squares_.begin() + slot * columns_);
+			*std::find(rowSlots_.begin(), rowSlots_.end(), lastSlot) = slot;
+		}
+		squares_.resize(squares_.size() - columns_);
 	}
 
-	bool TetrisBoard::isRowEmpty(int row) const {
+	void TetrisBoard::removeRows(int lowestRow, unsigned int rows) {
+		const int removedRows = std::popcount(rows);
+		const int highestRow = lowestRow + std::bit_width(rows) - 1;
+		const int storedRows = getStoredRows();
+
+		std::array<int, 4> removedSlots;
+		assert(removedRows <= static_cast<int>(removedSlots.size()));
+		int removed = 0;
+		int row = lowestRow;
+		for (int i = lowestRow; i < storedRows; ++i) {
+			if (i <= highestRow && (rows >> (i - lowestRow) & 1)) {
+				removedSlots[removed++] = rowSlots_[i];
+			} else {
+				rowSlots_[row] = rowSlots_[i];
+				rowMasks_[row] = rowMasks_[i];
+				++row;
+			}
+		}
+		rowSlots_.resize(row);
+		rowMasks_.resize(row);
+
+		// All columns are filled in the removed rows, the columns with the highest square in the highest removed row need a new height.
+		RowMask columns = 0;
 		for (int column = 0; column < columns_; ++column) {
-			if (board(column, row) != BlockType::Empty) {
-				return false;
+			if (columnHeights_[column] == highestRow + 1) {
+				columns |= RowMask{1} << column;
+			} else {
+				columnHeights_[column] -= removedRows;
 			}
 		}
-		return true;
+		updateColumnHeights(columns, highestRow + 1 - removedRows);
+		updateHighestUsedRow();
+		// All squares above the removed rows have moved.
+		initSquaresHash();
+
+		// Replace the removed rows with empty rows at the top, in the same slots, until the board has all rows.
+		const int paddedRows = std::clamp(rows_ - getStoredRows(), 0, removedRows);
+		for (int i = 0; i < paddedRows; ++i) {
+			std::fill_n(squares_.begin() + removedSlots[i] * columns_, columns_, BlockType::Empty);
+			rowSlots_.push_back(removedSlots[i]);
+			rowMasks_.push_back(0);
+		}
+		// Highest slot first, the last slot moved by releaseRowSlot is then never a removed one.
+		std::sort(removedSlots.begin() + paddedRows, removedSlots.begin() + removedRows, std::greater{});
+		for (int i = paddedRows; i < removedRows; ++i) {
+			releaseRowSlot(removedSlots[i]);
+		}
 	}
 
-	bool TetrisBoard::isRowFilled(int row) const {
-		for (int column = 0; column < columns_; ++column) {
-			if (board(column, row) == BlockType::Empty) {
-				return false;
+	int TetrisBoard::applyPlacement(const Block& block, PlacementUndo& undo) {
+		undo.block = block;
+		undo.current = current_;
+		undo.removedRows = 0;
+		undo.columnHeights = columnHeights_;
+		undo.highestUsedRow = highestUsedRow_;
+		undo.squaresHash = squaresHash_;
+
+		addBlockToBoard(block);
+		removeFilledRows(block, [&](BoardEvent event, int row) {
+			if (event == BoardEvent::RowToBeRemoved) {
+				const int index = undo.removedRows++;
+				// The rows are removed after all events, the rows below are still stored.
+				const int storedRow = row + index;
+				undo.rowIndexes[index] = row;
+				undo.rowsPadded[index] = getStoredRows() - index <= rows_;
+				undo.rowMasks[index] = rowMasks_[storedRow];
+				std::copy_n(squares_.begin() + rowSlots_[storedRow] * columns_, columns_, undo.rows[index].begin());
+			}
+		});
+		current_ = createBlock(next_);
+		return undo.removedRows;
+	}
+
+	void TetrisBoard::undoPlacement(const PlacementUndo& undo) {
+		for (int i = undo.removedRows - 1; i >= 0; --i) {
+			int slot;
+			if (undo.rowsPadded[i]) {
+				// The empty row added at the top gets the squares of the removed row back.
+				slot = rowSlots_.back();
+				rowSlots_.pop_back();
+				rowMasks_.pop_back();
+			} else {
+				slot = static_cast<int>(squares_.size()) / columns_;
+				squares_.resize(squares_.size() + columns_);
 			}
+			const int row = undo.rowIndexes[i];
+			std::copy_n(undo.rows[i].begin(), columns_, squares_.begin() + slot * columns_);
+			rowSlots_.insert(rowSlots_.begin() + row, slot);
+			rowMasks_.insert(rowMasks_.begin() + row, undo.rowMasks[i]);
 		}
-		return true;
+		for (const auto& sq : undo.block) {
+			board(sq.column, sq.row) = BlockType::Empty;
+			rowMasks_[sq.row] &= ~(RowMask{1} << sq.column);
+		}
+		columnHeights_ = undo.columnHeights;
+		highestUsedRow_ = undo.highestUsedRow;
+		squaresHash_ = undo.squaresHash;
+		current_ = undo.current;
+	}
+
+	void TetrisBoard::addBlockToBoard(const Block& block) {
+		for (const auto& sq : block) {
+			board(sq.column, sq.row) = block.getBlockType();
+			rowMasks_[sq.row] |= RowMask{1} << sq.column;
+			columnHeights_[sq.column] = std::max(columnHeights_[sq.column], sq.row + 1);
+			squaresHash_ ^= zobrist::squareKey(sq.column, sq.row);
+		}
+		highestUsedRow_ = std::max(highestUsedRow_, block.getLowestRow() + block.getShape().maxRow - block.getShape().minRow);
+	}
+
+	Block TetrisBoard::createBlock(BlockType blockType) const {
+		return Block{blockType, columns_ / 2 - 1, rows_ - 4}; // 4 rows are the starting area.
 	}
 
 	BlockType TetrisBoard::getBlockType(int column, int row) const {
 		if (column < 0 || column >= columns_ || row < 0) {
 			return BlockType::Wall;
 		}
-		if (row * columns_ + column >= static_cast<int>(gameboard_.size())) {
+		if (row >= getStoredRows()) {
 			return BlockType::Empty;
 		}
 		return board(column, row);
 	}
 
 	int TetrisBoard::calculateSquaresFilled(int row) const {
-		if (row >= static_cast<int>(gameboard_.size()) / columns_) {
-			return 0;
-		}
-		int filled = 0;
-		for (int x = 0; x < columns_; ++x) {
-			if (board(x, row) != BlockType::Empty) {
-				++filled;
-			}
-		}
-		return filled;
+		return std::popcount(getRowMask(row));
 	}
 
 	bool TetrisBoard::collision(const Block& block) const {
-		bool collision = false;
+		const auto& shape = block.getShape();
+		const int column = block.getStartColumn() + shape.minColumn;
+		const int row = block.getLowestStartRow() + shape.minRow;
+		if (column < 0 || block.getStartColumn() + shape.maxColumn >= columns_ || row < 0) {
+			return true;
+		}
 
-		for (const auto& sq : block) {
-			if (getBlockType(sq.column, sq.row) != BlockType::Empty) {
-				collision = true;
-				break;
+		const int height = std::min(shape.maxRow - shape.minRow + 1, static_cast<int>(rowMasks_.size()) - row);
+		for (int i = 0; i < height; ++i) {
+			if (rowMasks_[row + i] & (shape.rowMasks[i] << column)) {
+				return true;
 			}
 		}
-
-		return collision;
+		return false;
 	}
 
 	bool TetrisBoard::isRowInsideBoard(int row) const {
-		return row >= 0 && row * columns_ < static_cast<int>(gameboard_.size());
+		return row >= 0 && row < getStoredRows();
 	}
 
 }
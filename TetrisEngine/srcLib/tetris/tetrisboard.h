@@ -3,8 +3,14 @@
 
 #include "block.h"
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <type_traits>
+#include <cstdint>
+#include <limits>
+#include <cassert>
+#include <bit>
 
 namespace tetris {
 
@@ -36,6 +42,26 @@ namespace tetris {
 
 	class TetrisBoard {
 	public:
+		static constexpr int MaxColumns = std::numeric_limits<RowMask>::digits;
+
+		// Index i holds the row above the highest non empty square in column i.
+		using ColumnHeights = std::array<int, MaxColumns>;
+
+		// Information needed to undo a placement made by applyPlacement().
+		struct PlacementUndo {
+			Block block;
+			Block current;
+			int removedRows = 0;
+			std::array<int, 4> rowIndexes;
+			std::array<bool, 4> rowsPadded;
+			std::array<RowMask, 4> rowMasks;
+			std::array<std::array<BlockType, MaxColumns>, 4> rows;
+			ColumnHeights columnHeights;
+			int highestUsedRow = 0;
+			std::uint64_t squaresHash = 0;
+		};
+
+		// Throws std::invalid_argument if columns is not between 1 and MaxColumns.
 		TetrisBoard(int columns, int rows, BlockType current, BlockType next);
 		TetrisBoard(const std::vector<BlockType>& board,
 			int columns, int rows, const Block& current, BlockType next);
@@ -57,6 +83,14 @@ namespace tetris {
 
 		void update(Move move);
 
+		// Add the block to the board, remove filled rows and let the next block become
+		// the current block, without any events. Same result as Move::DownGravity
+		// for a block at ground. Return the number of removed rows.
+		int applyPlacement(const Block& block, PlacementUndo& undo);
+
+		// Restore the board to the state before applyPlacement() was called.
+		void undoPlacement(const PlacementUndo& undo);
+
 		void update(Move move, EventCallback auto&& eventCallback);
 
 		void setNextBlock(BlockType next);
@@ -68,6 +102,10 @@ namespace tetris {
 		Block getBlockDown() const;
 		Block getBlockDown(Block current) const;
 
+		// Same result as getBlockDown(current), but the landing row is calculated from
+		// the column heights instead of moving the block one row at a time.
+		Block getBlockDown(const Block& current, const ColumnHeights& heights) const;
+
 		int getRows() const {
 			return rows_;
 		}
@@ -80,9 +118,9 @@ namespace tetris {
 			return isGameOver_;
 		}
 
-		// Return all non moving squares on the board. Index 0 to (rows+4)*columns-1.
-		// All squares are saved in row major order and in ascending order.
-		const std::vector<BlockType>& getBoardVector() const;
+		// Return a copy of all non moving squares on the board. Index 0 to (rows+4)*columns-1.
+		// All squares are in row major order and in ascending order.
+		std::vector<BlockType> getBoardVector() const;
 
 		// Return the moving block.
 		Block getBlock() const {
@@ -106,34 +144,105 @@ namespace tetris {
 
 		bool collision(const Block& block) const;
 
+		// Return the mask for all non empty squares in the row. Rows outside the board are empty.
+		RowMask getRowMask(int row) const {
+			if (row < 0 || row >= static_cast<int>(rowMasks_.size())) {
+				return 0;
+			}
+			return rowMasks_[row];
+		}
+
+		// Return the mask with all columns set.
+		RowMask getFilledRowMask() const {
+			return filledRowMask_;
+		}
+
+		// Return the row masks for all stored rows, index 0 is the lowest row.
+		const std::vector<RowMask>& getRowMasks() const {
+			return rowMasks_;
+		}
+
+		// Return the column heights, updated each time the board changes.
+		const ColumnHeights& getColumnHeights() const {
+			return columnHeights_;
+		}
+
+		// Return the highest row with a non empty square, 0 for an empty board.
+		int getHighestUsedRow() const {
+			return highestUsedRow_;
+		}
+
+		// Return the Zobrist hash of the non empty squares, updated each time the board changes.
+		// Boards with the same non empty squares have the same hash, independent of the block types.
+		std::uint64_t getSquaresHash() const {
+			return squaresHash_;
+		}
+
+		// Return the Zobrist hash of the non empty squares and the current and next block types.
+		std::uint64_t getHash() const;
+
 	private:
 		void removeUnfilledRows();
 
 		void removeEmptyRowsOutsideBoard();
 
+		void initRowSlots();
+
+		void initRowMasks();
+
+		void initColumnHeights();
+
+		// Lower the heights of the columns provided to the highest non empty square below the row.
+		void updateColumnHeights(RowMask columns, int row);
+
+		void updateHighestUsedRow();
+
+		void initSquaresHash();
+
 		bool isRowInsideBoard(int row) const;
 
+		int getStoredRows() const {
+			return static_cast<int>(rowSlots_.size());
+		}
+
+		// Remove the slot, no longer used by any row. The last slot is moved to its place.
+		void releaseRowSlot(int slot);
+
 		BlockType& board(int column, int row) {
-			return gameboard_[row * columns_ + column];
+			return squares_[rowSlots_[row] * columns_ + column];
 		}
 
 		BlockType board(int column, int row) const {
-			return gameboard_[row * columns_ + column];
+			return squares_[rowSlots_[row] * columns_ + column];
 		}
 
 		Block createBlock(BlockType blockType) const;
 
-		bool isRowEmpty(int row) const;
+		bool isRowEmpty(int row) const {
+			return rowMasks_[row] == 0;
+		}
 
-		bool isRowFilled(int row) const;
+		bool isRowFilled(int row) const {
+			return rowMasks_[row] == filledRowMask_;
+		}
 
 		void addBlockToBoard(const Block& block);
 
 		void removeFilledRows(const Block& block, EventCallback auto&& callback);
 
-		void moveRowsOneStepDown(int rowToRemove, EventCallback auto&& callback);
-
-		std::vector<BlockType> gameboard_;
+		// Remove the rows lowestRow + i for each bit i set in rows, all filled, and move the rows
+		// above down in one pass.
+		void removeRows(int lowestRow, unsigned int rows);
+
+		// The squares of the stored rows, one slot of columns squares for each row, in any order.
+		// Row i is in slot rowSlots_[i], i.e. removing or adding a row only moves the indexes.
+		std::vector<BlockType> squares_;
+		std::vector<int> rowSlots_;
+		std::vector<RowMask> rowMasks_;
+		ColumnHeights columnHeights_{};
+		int highestUsedRow_ = 0;
+		std::uint64_t squaresHash_ = 0;
+		RowMask filledRowMask_;
 		BlockType next_;
 		Block current_;
 		int columns_;
@@ -143,8 +252,24 @@ namespace tetris {
 
 	template <typename Rows>
 	int TetrisBoard::addExternalRows(const Rows& externalRows) {
-		gameboard_.insert(gameboard_.begin(), std::begin(externalRows), std::end(externalRows));
-		return static_cast<int>(externalRows.size()) / columns_;
+		const int rows = static_cast<int>(externalRows.size()) / columns_;
+		rowMasks_.insert(rowMasks_.begin(), rows, 0);
+		// The new rows are added as new slots at the end, below the other rows.
+		const int firstSlot = static_cast<int>(squares_.size()) / columns_;
+		rowSlots_.insert(rowSlots_.begin(), rows, 0);
+		auto it = std::begin(externalRows);
+		for (int row = 0; row < rows; ++row) {
+			rowSlots_[row] = firstSlot + row;
+			for (int column = 0; column < columns_; ++column, ++it) {
+				squares_.push_back(*it);
+				if (*it != BlockType::Empty) {
+					rowMasks_[row] |= RowMask{1} << column;
+				}
+			}
+		}
+		initColumnHeights();
+		initSquaresHash();
+		return rows;
 	}
 
 	inline void TetrisBoard::update(Move move) {
@@ -232,38 +357,28 @@ namespace tetris {
 	}
 
 	void TetrisBoard::removeFilledRows(const Block& block, EventCallback auto&& callback) {
-		int row = block.getLowestRow();
-		int rowsFilled = 0;
-		const int nbrOfSquares = static_cast<int>(current_.getSize());
-		for (int i = 0; i < nbrOfSquares; ++i) {
-			bool filled = false;
-			if (isRowInsideBoard(row)) {
-				filled = isRowFilled(row);
-			}
-			if (filled) {
-				moveRowsOneStepDown(row, callback);
-				++rowsFilled;
-			} else {
-				++row;
+		const int lowestRow = block.getLowestRow();
+		const int nbrOfRows = std::min(static_cast<int>(block.getSize()), getStoredRows() - lowestRow);
+		// Bit i is set if row lowestRow + i is filled.
+		unsigned int filledRows = 0;
+		for (int i = std::max(-lowestRow, 0); i < nbrOfRows; ++i) {
+			if (isRowFilled(lowestRow + i)) {
+				filledRows |= 1u << i;
 			}
 		}
-
-		if (rowsFilled > 0) {
-			callback(BoardEvent::RowsRemoved, rowsFilled);
+		if (filledRows == 0) {
+			return;
 		}
-	}
-
-	void TetrisBoard::moveRowsOneStepDown(int rowToRemove, EventCallback auto&& callback) {
-		callback(BoardEvent::RowToBeRemoved, rowToRemove);
 
-		auto indexStartOfRow = rowToRemove * columns_;
-		gameboard_.erase(gameboard_.begin() + indexStartOfRow, gameboard_.begin() + indexStartOfRow + columns_);
-
-		// Is it necessary to replace the row?
-		if (static_cast<int>(gameboard_.size()) < rows_ * columns_) {
-			// Replace the removed row with an empty row at the top.
-			gameboard_.insert(gameboard_.end(), columns_, BlockType::Empty);
+		// The row is the one after the filled rows below are removed, i.e. the same rows as when
+		// removing one row at a time. The board is unchanged until all events are sent.
+		int rowsFilled = 0;
+		for (auto rows = filledRows; rows != 0; rows &= rows - 1) {
+			callback(BoardEvent::RowToBeRemoved, lowestRow + std::countr_zero(rows) - rowsFilled);
+			++rowsFilled;
 		}
+		removeRows(lowestRow, filledRows);
+		callback(BoardEvent::RowsRemoved, rowsFilled);
 	}
 
 }
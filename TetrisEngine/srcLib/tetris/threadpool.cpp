@@ -0,0 +1,87 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+namespace tetris {
+
+	ThreadPool::ThreadPool(int threads) {
+		threads = std::max(1, threads);
+		workers_.reserve(threads - 1);
+		for (int thread = 1; thread < threads; ++thread) {
+			workers_.emplace_back([this, thread] {
+				runWorker(thread);
+			});
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard lock{mutex_};
+			stop_ = true;
+		}
+		startCondition_.notify_all();
+		// The jthreads are joined when destroyed.
+		workers_.clear();
+	}
+
+	void ThreadPool::parallelFor(int tasks, const std::function<void(int task, int thread)>& function) {
+		if (workers_.empty() || tasks <= 1) {
+			for (int task = 0; task < tasks; ++task) {
+				function(task, 0);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard lock{mutex_};
+			function_ = &function;
+			tasks_ = tasks;
+			nextTask_ = 0;
+			runningWorkers_ = static_cast<int>(workers_.size());
+			++generation_;
+		}
+		startCondition_.notify_all();
+
+		runTasks(0);
+
+		std::unique_lock lock{mutex_};
+		doneCondition_.wait(lock, [this] {
+			return runningWorkers_ == 0;
+		});
+		function_ = nullptr;
+	}
+
+	void ThreadPool::runWorker(int thread) {
+		int generation = 0;
+		while (true) {
+			{
+				std::unique_lock lock{mutex_};
+				startCondition_.wait(lock, [&] {
+					return stop_ || generation_ != generation;
+				});
+				if (stop_) {
+					return;
+				}
+				generation = generation_;
+			}
+
+			runTasks(thread);
+
+			bool done = false;
+			{
+				std::lock_guard lock{mutex_};
+				done = --runningWorkers_ == 0;
+			}
+			if (done) {
+				doneCondition_.notify_one();
+			}
+		}
+	}
+
+	void ThreadPool::runTasks(int thread) {
+		for (int task = nextTask_++; task < tasks_; task = nextTask_++) {
+			(*function_)(task, thread);
+		}
+	}
+
+}
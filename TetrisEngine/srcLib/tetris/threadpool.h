@@ -0,0 +1,54 @@
+#ifndef TETRIS_THREADPOOL_H
+#define TETRIS_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+	// Fixed number of threads running the tasks of one call at a time. The calling
+	// thread runs tasks too, and tasks are handed out one at a time to the first free thread.
+	class ThreadPool {
+	public:
+		// The number of threads includes the calling thread, at least one.
+		explicit ThreadPool(int threads = static_cast<int>(std::thread::hardware_concurrency()));
+
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		int getThreads() const {
+			return static_cast<int>(workers_.size()) + 1;
+		}
+
+		// Call function(task, thread) for all tasks in [0, tasks) and wait until all are done.
+		// The thread is in [0, getThreads()), 0 is the calling thread. Tasks run on the
+		// same thread are called one after another.
+		void parallelFor(int tasks, const std::function<void(int task, int thread)>& function);
+
+	private:
+		void runWorker(int thread);
+
+		void runTasks(int thread);
+
+		std::vector<std::jthread> workers_;
+		std::mutex mutex_;
+		std::condition_variable startCondition_;
+		std::condition_variable doneCondition_;
+
+		const std::function<void(int, int)>* function_ = nullptr;
+		int tasks_ = 0;
+		std::atomic<int> nextTask_ = 0;
+		int generation_ = 0;
+		int runningWorkers_ = 0;
+		bool stop_ = false;
+	};
+
+}
+
+#endif
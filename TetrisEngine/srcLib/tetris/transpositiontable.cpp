@@ -0,0 +1,18 @@
+#include "transpositiontable.h"
+
+#include <bit>
+
+namespace tetris {
+
+	TranspositionTable::TranspositionTable(int size) {
+		if (size > 0) {
+			entries_.resize(std::bit_ceil(static_cast<unsigned int>(size)));
+			mask_ = entries_.size() - 1;
+		}
+	}
+
+	void TranspositionTable::clear() {
+		entries_.assign(entries_.size(), Entry{});
+	}
+
+}
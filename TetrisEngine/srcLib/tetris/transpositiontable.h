@@ -0,0 +1,60 @@
+#ifndef TETRIS_TRANSPOSITIONTABLE_H
+#define TETRIS_TRANSPOSITIONTABLE_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tetris {
+
+	// Bounded cache of values by a 64 bit hash key. Each key has one slot, a new value
+	// replaces the old value in the slot.
+	class TranspositionTable {
+	public:
+		// Suggested size, 8 bytes for each entry.
+		static constexpr int DefaultSize = 1 << 16;
+
+		// The size is rounded up to a power of two. Size 0 gives a table which stores nothing.
+		explicit TranspositionTable(int size = 0);
+
+		std::optional<float> find(std::uint64_t key) const {
+			if (entries_.empty()) {
+				return std::nullopt;
+			}
+			const auto& entry = entries_[key & mask_];
+			if (entry.check != calculateCheck(key)) {
+				return std::nullopt;
+			}
+			return entry.value;
+		}
+
+		void insert(std::uint64_t key, float value) {
+			if (!entries_.empty()) {
+				entries_[key & mask_] = Entry{calculateCheck(key), value};
+			}
+		}
+
+		void clear();
+
+		int getSize() const {
+			return static_cast<int>(entries_.size());
+		}
+
+	private:
+		// The high bits of the key, never zero, in order for zero to mark an empty slot.
+		static std::uint32_t calculateCheck(std::uint64_t key) {
+			return static_cast<std::uint32_t>(key >> 32) | 1;
+		}
+
+		struct Entry {
+			std::uint32_t check = 0;
+			float value = 0.f;
+		};
+
+		std::vector<Entry> entries_;
+		std::uint64_t mask_ = 0;
+	};
+
+}
+
+#endif
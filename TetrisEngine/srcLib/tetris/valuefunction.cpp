@@ -0,0 +1,268 @@
+#include "valuefunction.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <string>
+
+namespace tetris {
+
+	namespace {
+
+		using Term = ValueFunction::Term;
+		using Polynomial = std::vector<Term>;
+
+		bool isSameMonomial(const Term& left, const Term& right) {
+			return left.degree == right.degree
+				&& std::equal(left.variables.begin(), left.variables.begin() + left.degree, right.variables.begin());
+		}
+
+		std::optional<Term> isConstant(const Polynomial& polynomial) {
+			if (polynomial.empty()) {
+				return Term{};
+			}
+			if (polynomial.size() == 1 && polynomial.front().degree == 0) {
+				return polynomial.front();
+			}
+			return std::nullopt;
+		}
+
+		// Terms are kept in the order they appear in the expression, in order to sum in the same
+		// order as the calculator.
+		void add(Polynomial& polynomial, const Term& term) {
+			auto it = std::find_if(polynomial.begin(), polynomial.end(), [&](const Term& other) {
+				return isSameMonomial(term, other);
+			});
+			if (it == polynomial.end()) {
+				polynomial.push_back(term);
+			} else {
+				it->coefficient += term.coefficient;
+			}
+		}
+
+		Polynomial negate(Polynomial polynomial) {
+			for (auto& term : polynomial) {
+				term.coefficient = -term.coefficient;
+			}
+			return polynomial;
+		}
+
+		// Insertion sort of the first degree variables, at most MaxDegree.
+		void sortVariables(Term& term) {
+			assert(term.degree >= 0 && term.degree <= ValueFunction::MaxDegree);
+			for (int i = 1; i < std::min(term.degree, ValueFunction::MaxDegree); ++i) {
+				const auto variable = term.variables[i];
+				int j = i;
+				for (; j > 0 && term.variables[j - 1] > variable; --j) {
+					term.variables[j] = term.variables[j - 1];
+				}
+				term.variables[j] = variable;
+			}
+		}
+
+		std::optional<Polynomial> multiply(const Polynomial& left, const Polynomial& right) {
+			Polynomial product;
+			for (const auto& leftTerm : left) {
+				for (const auto& rightTerm : right) {
+					if (leftTerm.degree + rightTerm.degree > ValueFunction::MaxDegree) {
+						return std::nullopt;
+					}
+					Term term{leftTerm.coefficient * rightTerm.coefficient, leftTerm.degree + rightTerm.degree};
+					std::copy_n(leftTerm.variables.begin(), leftTerm.degree, term.variables.begin());
+					std::copy_n(rightTerm.variables.begin(), rightTerm.degree, term.variables.begin() + leftTerm.degree);
+					sortVariables(term);
+					add(product, term);
+				}
+			}
+			return product;
+		}
+
+		// Recursive descent parser, same grammar and precedence as the calculator.
+		class Parser {
+		public:
+			explicit Parser(std::string_view expression)
+				: expression_{expression} {
+			}
+
+			std::optional<Polynomial> parse() {
+				auto polynomial = parseExpression();
+				skipSpaces();
+				if (!polynomial || index_ != expression_.size()) {
+					return std::nullopt;
+				}
+				return polynomial;
+			}
+
+		private:
+			// expression = term {("+" | "-") term}
+			std::optional<Polynomial> parseExpression() {
+				auto polynomial = parseTerm();
+				while (polynomial) {
+					if (consume('+')) {
+						auto right = parseTerm();
+						if (!right) {
+							return std::nullopt;
+						}
+						for (const auto& term : *right) {
+							add(*polynomial, term);
+						}
+					} else if (consume('-')) {
+						auto right = parseTerm();
+						if (!right) {
+							return std::nullopt;
+						}
+						for (const auto& term : negate(*right)) {
+							add(*polynomial, term);
+						}
+					} else {
+						break;
+					}
+				}
+				return polynomial;
+			}
+
+			// term = power {("*" | "/") power}
+			std::optional<Polynomial> parseTerm() {
+				auto polynomial = parsePower();
+				while (polynomial) {
+					if (consume('*')) {
+						auto right = parsePower();
+						if (!right) {
+							return std::nullopt;
+						}
+						polynomial = multiply(*polynomial, *right);
+					} else if (consume('/')) {
+						auto right = parsePower();
+						if (!right) {
+							return std::nullopt;
+						}
+						// Only division by a constant keeps the polynomial form.
+						auto divisor = isConstant(*right);
+						if (!divisor || divisor->coefficient == 0.f) {
+							return std::nullopt;
+						}
+						for (auto& term : *polynomial) {
+							term.coefficient /= divisor->coefficient;
+						}
+					} else {
+						break;
+					}
+				}
+				return polynomial;
+			}
+
+			// power = unary ["^" power]
+			std::optional<Polynomial> parsePower() {
+				auto base = parseUnary();
+				if (!base || !consume('^')) {
+					return base;
+				}
+				auto exponentPolynomial = parsePower();
+				if (!exponentPolynomial) {
+					return std::nullopt;
+				}
+				auto exponent = isConstant(*exponentPolynomial);
+				if (!exponent || exponent->coefficient < 0.f || exponent->coefficient > ValueFunction::MaxDegree
+					|| std::floor(exponent->coefficient) != exponent->coefficient) {
+					return std::nullopt;
+				}
+				std::optional<Polynomial> power = Polynomial{Term{1.f}};
+				for (int i = 0; power && i < static_cast<int>(exponent->coefficient); ++i) {
+					power = multiply(*power, *base);
+				}
+				return power;
+			}
+
+			// unary = "-" unary | primary
+			std::optional<Polynomial> parseUnary() {
+				if (consume('-')) {
+					auto polynomial = parseUnary();
+					if (!polynomial) {
+						return std::nullopt;
+					}
+					return negate(*polynomial);
+				}
+				return parsePrimary();
+			}
+
+			// primary = number | variable | "(" expression ")"
+			std::optional<Polynomial> parsePrimary() {
+				skipSpaces();
+				if (consume('(')) {
+					auto polynomial = parseExpression();
+					if (!polynomial || !consume(')')) {
+						return std::nullopt;
+					}
+					return polynomial;
+				}
+				if (index_ >= expression_.size()) {
+					return std::nullopt;
+				}
+
+				const char chr = expression_[index_];
+				if (std::isdigit(static_cast<unsigned char>(chr)) || chr == '.') {
+					float number = 0.f;
+					const auto [end, error] = std::from_chars(expression_.data() + index_, expression_.data() + expression_.size(), number);
+					if (error != std::errc{}) {
+						return std::nullopt;
+					}
+					index_ = end - expression_.data();
+					return Polynomial{Term{number}};
+				}
+				if (std::isalpha(static_cast<unsigned char>(chr))) {
+					const auto start = index_;
+					while (index_ < expression_.size()
+						&& (std::isalnum(static_cast<unsigned char>(expression_[index_])) || expression_[index_] == '_')) {
+						++index_;
+					}
+					const auto name = expression_.substr(start, index_ - start);
+					auto it = std::find(AiVariableNames.begin(), AiVariableNames.end(), name);
+					if (it == AiVariableNames.end()) {
+						// Unknown variable or a function.
+						return std::nullopt;
+					}
+					Term term{1.f, 1};
+					term.variables[0] = static_cast<std::int8_t>(it - AiVariableNames.begin());
+					return Polynomial{term};
+				}
+				return std::nullopt;
+			}
+
+			bool consume(char chr) {
+				skipSpaces();
+				if (index_ < expression_.size() && expression_[index_] == chr) {
+					++index_;
+					return true;
+				}
+				return false;
+			}
+
+			void skipSpaces() {
+				while (index_ < expression_.size() && std::isspace(static_cast<unsigned char>(expression_[index_]))) {
+					++index_;
+				}
+			}
+
+			std::string_view expression_;
+			std::size_t index_ = 0;
+		};
+
+	}
+
+	std::optional<ValueFunction> ValueFunction::compile(std::string_view expression) {
+		auto polynomial = Parser{expression}.parse();
+		if (!polynomial) {
+			return std::nullopt;
+		}
+		return ValueFunction{std::move(*polynomial)};
+	}
+
+	bool ValueFunction::isLinear() const {
+		return std::all_of(terms_.begin(), terms_.end(), [](const Term& term) {
+			return term.degree <= 1;
+		});
+	}
+
+}
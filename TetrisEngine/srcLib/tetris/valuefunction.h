@@ -0,0 +1,85 @@
+#ifndef TETRIS_VALUEFUNCTION_H
+#define TETRIS_VALUEFUNCTION_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace tetris {
+
+	// The variables available in a value function, the value is the index in AiVariables.
+	enum class AiVariable {
+		LandingHeight,
+		ErodedPieces,
+		RowHoles,
+		ColumnHoles,
+		Holes,
+		CumulativeWells,
+		HoleDepth,
+		Rows,
+		Columns
+	};
+
+	inline constexpr std::array<const char*, 9> AiVariableNames{
+		"landingHeight",
+		"erodedPieces",
+		"rowHoles",
+		"columnHoles",
+		"holes",
+		"cumulativeWells",
+		"holeDepth",
+		"rows",
+		"columns"
+	};
+
+	using AiVariables = std::array<float, AiVariableNames.size()>;
+
+	// A value function compiled to a polynomial over the variables. Evaluating it does
+	// not look up variables by name, as the calculator does.
+	class ValueFunction {
+	public:
+		static constexpr int MaxDegree = 4;
+
+		// Return the polynomial of the expression, or nothing when the expression is not a
+		// polynomial over the variables, e.g. division by a variable or an unknown function.
+		static std::optional<ValueFunction> compile(std::string_view expression);
+
+		float evaluate(const AiVariables& variables) const {
+			float value = 0.f;
+			for (const auto& term : terms_) {
+				float product = term.coefficient;
+				for (int i = 0; i < term.degree; ++i) {
+					product *= variables[term.variables[i]];
+				}
+				value += product;
+			}
+			return value;
+		}
+
+		// Return true if no term has a product of variables.
+		bool isLinear() const;
+
+		struct Term {
+			float coefficient = 0.f;
+			int degree = 0;
+			// The first degree variables, sorted.
+			std::array<std::int8_t, MaxDegree> variables{};
+		};
+
+		const std::vector<Term>& getTerms() const {
+			return terms_;
+		}
+
+	private:
+		explicit ValueFunction(std::vector<Term> terms)
+			: terms_{std::move(terms)} {
+		}
+
+		std::vector<Term> terms_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TETRIS_ZOBRIST_H
+#define TETRIS_ZOBRIST_H
+
+#include "block.h"
+
+#include <cstdint>
+
+namespace tetris::zobrist {
+
+	// Return well mixed bits of the value (the splitmix64 finalizer). Zero only for zero.
+	constexpr std::uint64_t mix(std::uint64_t value) {
+		value ^= value >> 30;
+		value *= 0xbf58476d1ce4e5b9ull;
+		value ^= value >> 27;
+		value *= 0x94d049bb133111ebull;
+		value ^= value >> 31;
+		return value;
+	}
+
+	// Random key for a non empty square. Computed instead of stored in a table, in order
+	// to not limit the number of rows.
+	constexpr std::uint64_t squareKey(int column, int row) {
+		return mix(0x9e3779b97f4a7c15ull * (static_cast<std::uint64_t>(row) * 64 + column + 1));
+	}
+
+	// Random key for the block type, different keys for different slots (e.g. current and next block).
+	constexpr std::uint64_t blockTypeKey(BlockType blockType, int slot) {
+		return mix(0xd1b54a32d192ed03ull * (static_cast<std::uint64_t>(slot) * 256 + static_cast<unsigned char>(blockType) + 1));
+	}
+
+}
+
+#endif